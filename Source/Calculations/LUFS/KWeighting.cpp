@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    KWeighting.cpp
+
+  ==============================================================================
+*/
+
+// sources:
+//https://www.itu.int/dms_pubrec/itu-r/rec/bs/R-REC-BS.1770-5-202311-I!!PDF-E.pdf
+//https://github.com/jiixyj/libebur128/blob/master/ebur128/ebur128.c (ebur128_init_filter)
+
+#include "KWeighting.h"
+
+KWeightingCoefficients KWeightingCoefficients::forSampleRate(double sampleRate)
+{
+    KWeightingCoefficients coefficients;
+
+    // Stage 1 - high shelf, +4dB above ~1.7kHz
+    {
+        const double f0 = 1681.974450955533;
+        const double G = 3.999843853973347;
+        const double Q = 0.7071752369554196;
+
+        const double K = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double Vh = std::pow(10.0, G / 20.0);
+        const double Vb = std::pow(Vh, 0.4996667741545416);
+        const double a0 = 1.0 + K / Q + K * K;
+
+        coefficients.high_shelf.b0 = (Vh + Vb * K / Q + K * K) / a0;
+        coefficients.high_shelf.b1 = 2.0 * (K * K - Vh) / a0;
+        coefficients.high_shelf.b2 = (Vh - Vb * K / Q + K * K) / a0;
+        coefficients.high_shelf.a1 = 2.0 * (K * K - 1.0) / a0;
+        coefficients.high_shelf.a2 = (1.0 - K / Q + K * K) / a0;
+    }
+
+    // Stage 2 - high pass at ~38Hz. BS.1770 keeps numerator as 1, -2, 1 (not normalised by a0), so its passband gain is a0
+    // (+0.04dB at 48kHz). a0 depends on sample rate - numerator is scaled to keep the passband gain of 48kHz at every rate.
+    {
+        const double f0 = 38.13547087602444;
+        const double Q = 0.5003270373238773;
+
+        const double K = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double a0 = 1.0 + K / Q + K * K;
+
+        const double K_48k = std::tan(juce::MathConstants<double>::pi * f0 / 48000.0);
+        const double gain = (1.0 + K_48k / Q + K_48k * K_48k) / a0;
+
+        coefficients.high_pass.b0 = gain;
+        coefficients.high_pass.b1 = -2.0 * gain;
+        coefficients.high_pass.b2 = gain;
+        coefficients.high_pass.a1 = 2.0 * (K * K - 1.0) / a0;
+        coefficients.high_pass.a2 = (1.0 - K / Q + K * K) / a0;
+    }
+
+    return coefficients;
+}
@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    KWeighting.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Coefficients of single biquad, normalised so a0 == 1. Kept in double - filters of float samples round them to float,
+// filters of double samples need them in full precision (high pass poles lie very close to z = 1 at high sample rates).
+struct BiquadCoefficients {
+    double b0;
+    double b1;
+    double b2;
+    double a1;
+    double a2;
+};
+
+// K-weighting filter from BS.1770: stage 1 - high shelf (head effects), stage 2 - high pass (RLB weighting)
+struct KWeightingCoefficients {
+    BiquadCoefficients high_shelf;
+    BiquadCoefficients high_pass;
+
+    // Coefficients derived analytically for given sample rate.
+    // For 48kHz they are equal to the ones published in BS.1770.
+    static KWeightingCoefficients forSampleRate(double sampleRate);
+};
+
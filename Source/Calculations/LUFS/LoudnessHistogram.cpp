@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    LoudnessHistogram.cpp
+
+  ==============================================================================
+*/
+
+// sources:
+//https://tech.ebu.ch/docs/tech/tech3341.pdf
+//https://github.com/jiixyj/libebur128/blob/master/ebur128/ebur128.c (histogram mode)
+
+#include "LoudnessHistogram.h"
+
+LoudnessHistogram::LoudnessHistogram() :
+    block_counts(),
+    power_sums(),
+    total_blocks_count(0),
+    total_power_sum(0.0)
+{
+}
+
+void LoudnessHistogram::clear()
+{
+    block_counts.fill(0);
+    power_sums.fill(0.0);
+    total_blocks_count = 0;
+    total_power_sum = 0.0;
+}
+
+void LoudnessHistogram::addBlock(double block_power)
+{
+    double loudness = powerToLoudness(block_power);
+
+    // gate 1 - absolute threshold
+    if (!(loudness > absolute_gate)) {
+        return;
+    }
+
+    int bin_index = getBinIndex(loudness);
+    block_counts[bin_index]++;
+    power_sums[bin_index] += block_power;
+
+    // Accumulators for calculating relative threshold
+    total_blocks_count++;
+    total_power_sum += block_power;
+}
+
+void LoudnessHistogram::merge(const LoudnessHistogram& other)
+{
+    for (int i = 0; i < bins_count; i++) {
+        block_counts[i] += other.block_counts[i];
+        power_sums[i] += other.power_sums[i];
+    }
+
+    total_blocks_count += other.total_blocks_count;
+    total_power_sum += other.total_power_sum;
+}
+
+void LoudnessHistogram::writeState(juce::OutputStream& stream) const
+{
+    int used_bins_count = 0;
+    for (int i = 0; i < bins_count; i++) {
+        used_bins_count += block_counts[i] > 0;
+    }
+
+    stream.writeInt64(static_cast<juce::int64>(total_blocks_count));
+    stream.writeDouble(total_power_sum);
+    stream.writeInt(used_bins_count);
+
+    for (int i = 0; i < bins_count; i++) {
+        if (block_counts[i] > 0) {
+            stream.writeShort(static_cast<short>(i));
+            stream.writeInt64(static_cast<juce::int64>(block_counts[i]));
+            stream.writeDouble(power_sums[i]);
+        }
+    }
+}
+
+bool LoudnessHistogram::readState(juce::InputStream& stream)
+{
+    clear();
+
+    const unsigned long long int blocks_count = static_cast<unsigned long long int>(stream.readInt64());
+    const double power_sum = stream.readDouble();
+    const int used_bins_count = stream.readInt();
+    if (used_bins_count < 0 || used_bins_count > bins_count || stream.getNumBytesRemaining() < used_bins_count * 18) {
+        return false;
+    }
+
+    for (int i = 0; i < used_bins_count; i++) {
+        const int bin_index = stream.readShort();
+        if (bin_index < 0 || bin_index >= bins_count) {
+            clear();
+            return false;
+        }
+        block_counts[bin_index] = static_cast<unsigned long long int>(stream.readInt64());
+        power_sums[bin_index] = stream.readDouble();
+    }
+
+    total_blocks_count = blocks_count;
+    total_power_sum = power_sum;
+    return true;
+}
+
+size_t LoudnessHistogram::getMaxStateSize()
+{
+    // totals and number of bins, then index, count and power sum of every bin
+    return 20 + bins_count * 18;
+}
+
+double LoudnessHistogram::calculateGatedLoudness(double relative_gate) const
+{
+    if (total_blocks_count == 0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+
+    int first_bin = getFirstBinAboveRelativeGate(relative_gate);
+
+    unsigned long long int gated_blocks_count = 0;
+    double gated_power_sum = 0.0;
+    for (int i = first_bin; i < bins_count; i++) {
+        gated_blocks_count += block_counts[i];
+        gated_power_sum += power_sums[i];
+    }
+
+    if (gated_blocks_count == 0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+
+    return powerToLoudness(gated_power_sum / gated_blocks_count);
+}
+
+double LoudnessHistogram::calculateLoudnessRange(double relative_gate, double low_percentile, double high_percentile) const
+{
+    if (total_blocks_count == 0) {
+        return 0.0;
+    }
+
+    int first_bin = getFirstBinAboveRelativeGate(relative_gate);
+
+    unsigned long long int gated_blocks_count = 0;
+    for (int i = first_bin; i < bins_count; i++) {
+        gated_blocks_count += block_counts[i];
+    }
+
+    if (gated_blocks_count == 0) {
+        return 0.0;
+    }
+
+    // Positions of percentiles in sorted gated blocks
+    const unsigned long long int low_position = static_cast<unsigned long long int>((gated_blocks_count - 1) * low_percentile);
+    const unsigned long long int high_position = static_cast<unsigned long long int>((gated_blocks_count - 1) * high_percentile);
+
+    // Walk through cumulative distribution, bins are already sorted by loudness
+    double low_loudness = getBinCentre(first_bin);
+    double high_loudness = getBinCentre(first_bin);
+    bool low_found = false;
+    unsigned long long int cumulative_count = 0;
+    for (int i = first_bin; i < bins_count; i++) {
+        if (block_counts[i] == 0) {
+            continue;
+        }
+        cumulative_count += block_counts[i];
+
+        if (!low_found && cumulative_count > low_position) {
+            low_loudness = getBinCentre(i);
+            low_found = true;
+        }
+        if (cumulative_count > high_position) {
+            high_loudness = getBinCentre(i);
+            break;
+        }
+    }
+
+    return high_loudness - low_loudness;
+}
+
+unsigned long long int LoudnessHistogram::getBlocksCount() const
+{
+    return total_blocks_count;
+}
+
+double LoudnessHistogram::powerToLoudness(double power)
+{
+    return -0.691 + 10.0 * std::log10(power);
+}
+
+int LoudnessHistogram::getBinIndex(double loudness) const
+{
+    // Louder blocks than highest_loudness (possible with many weighted surround channels) land in the last bin
+    return juce::jlimit(0, bins_count - 1, static_cast<int>((loudness - absolute_gate) / bin_width));
+}
+
+int LoudnessHistogram::getFirstBinAboveRelativeGate(double relative_gate) const
+{
+    // gate 2 - relative threshold, based on average power of all blocks that passed gate 1
+    double relative_threshold = powerToLoudness(total_power_sum / total_blocks_count) + relative_gate;
+
+    // First bin which center is above the relative threshold
+    int first_bin = static_cast<int>(std::ceil((relative_threshold - absolute_gate) / bin_width - 0.5));
+    return juce::jlimit(0, bins_count, first_bin);
+}
+
+double LoudnessHistogram::getBinCentre(int bin_index) const
+{
+    return absolute_gate + (bin_index + 0.5) * bin_width;
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    LoudnessHistogram.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Histogram of block loudness values, used for gating of integrated loudness (BS.1770, 400ms blocks)
+// and for loudness range (EBU Tech 3342, 3s short term blocks).
+// Blocks are put into 0.1 LU wide bins between -70 LUFS (absolute gate) and +30 LUFS.
+// Each bin keeps number of blocks and sum of their powers, so average power of gated blocks is exact,
+// only position of the relative gate is rounded to the nearest bin edge.
+// Blocks that lie within 0.05 LU of the relative gate may be gated wrongly. With k such blocks and n blocks above them,
+// integrated loudness differs from exact two-pass calculation by at most 10 * log10(1 + k / n) LU - below 0.1 LU
+// (EBU Tech 3341 tolerance) while k is under 2.3% of n. Programme loudness spreads over many LU, errors are around 0.01 LU.
+// Memory is constant, no matter how long the measurement is.
+class LoudnessHistogram {
+public:
+    LoudnessHistogram();
+
+    void clear();
+
+    // block_power - channel weighted mean square of the block (sum of G_i * z_i from BS.1770)
+    void addBlock(double block_power);
+
+    // Adds all blocks of other histogram, as if they were added to this one. Used to join partial results
+    // of one file measured in chunks.
+    void merge(const LoudnessHistogram& other);
+
+    // Two-pass gating: average of blocks above absolute gate gives relative gate (that average + relative_gate LU),
+    // then average of blocks above both gates gives the loudness.
+    // Returns -inf if there are no blocks above the gates.
+    double calculateGatedLoudness(double relative_gate) const;
+
+    // Loudness range (EBU Tech 3342): difference between high_percentile and low_percentile (0.0 - 1.0) of loudness distribution
+    // of blocks above both gates. Percentiles are resolved to centres of 0.1 LU bins - each lies within 0.05 LU of a block
+    // whose rank in exact calculation differs by at most 2k + 1 (k - blocks within 0.05 LU of the relative gate).
+    // Returns 0 if there are no blocks above the gates.
+    double calculateLoudnessRange(double relative_gate, double low_percentile, double high_percentile) const;
+
+    unsigned long long int getBlocksCount() const;
+
+    // Saved state - only bins that have any blocks are written, so short measurements give short state.
+    // readState returns false (and leaves histogram cleared) if data is broken.
+    void writeState(juce::OutputStream& stream) const;
+    bool readState(juce::InputStream& stream);
+    static size_t getMaxStateSize();
+
+    static double powerToLoudness(double power);
+
+    static constexpr double absolute_gate = -70.0;
+
+private:
+    int getBinIndex(double loudness) const;
+    int getFirstBinAboveRelativeGate(double relative_gate) const;
+    double getBinCentre(int bin_index) const;
+
+    static constexpr double highest_loudness = 30.0;
+    static constexpr double bin_width = 0.1;
+    static constexpr int bins_count = 1000; // (highest_loudness - absolute_gate) / bin_width
+
+    std::array<unsigned long long int, bins_count> block_counts; // Number of blocks in each bin
+    std::array<double, bins_count> power_sums; // Sum of powers of blocks in each bin
+
+    unsigned long long int total_blocks_count;
+    double total_power_sum;
+};
@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+    LoudnessHistoryFifo.cpp
+
+  ==============================================================================
+*/
+
+#include "LoudnessHistoryFifo.h"
+
+LoudnessHistoryFifo::LoudnessHistoryFifo(int capacity) :
+    fifo(capacity),
+    points(static_cast<size_t>(capacity))
+{
+}
+
+bool LoudnessHistoryFifo::push(const Point& point)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 + size2 == 0) {
+        return false;
+    }
+
+    points[static_cast<size_t>(size1 > 0 ? start1 : start2)] = point;
+    fifo.finishedWrite(1);
+    return true;
+}
+
+int LoudnessHistoryFifo::pop(Point* destination, int maxCount)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(maxCount, start1, size1, start2, size2);
+
+    // Queued points may wrap around the end of the buffer
+    std::copy(points.begin() + start1, points.begin() + start1 + size1, destination);
+    std::copy(points.begin() + start2, points.begin() + start2 + size2, destination + size1);
+
+    fifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+void LoudnessHistoryFifo::discardAll()
+{
+    // Consumer may move read position on its own, so this is safe while audio thread pushes
+    fifo.finishedRead(fifo.getNumReady());
+}
@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+
+    LoudnessHistoryFifo.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Wait-free single producer / single consumer queue of loudness values, one point per 100ms bin.
+// Audio thread pushes, editor drains it on its timer - so no value is lost between timer ticks.
+// Memory is allocated in constructor, push and pop never lock or allocate.
+class LoudnessHistoryFifo {
+public:
+    struct Point {
+        float momentary_loudness;
+        float short_term_loudness; // -inf during the first 3s
+    };
+
+    LoudnessHistoryFifo(int capacity = 256);
+
+    // Audio thread. Returns false if the queue is full (nobody drains it, e.g. editor is closed) - point is dropped then.
+    bool push(const Point& point);
+
+    // Message thread. Copies up to maxCount oldest points to destination, returns number of copied points.
+    int pop(Point* destination, int maxCount);
+
+    // Message thread - drops everything that was queued so far
+    void discardAll();
+
+private:
+    juce::AbstractFifo fifo;
+    std::vector<Point> points;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoudnessHistoryFifo)
+};
@@ -16,32 +16,52 @@
 #include "LufsCalculations.h"
 
 LufsCalculations::LufsCalculations() :
-    filter1(),
-    filter2(),
+    filterCoefficients(),
     channels(),
-    // temp vars:
+    prepared_channels_count(0),
+    channel_momentary_powers(),
+    channel_short_term_powers(),
+    update_interval_sub_bins(LufsChannelBank::sub_bins_per_bin),
+    gating_histogram(),
+    loudness_range_histogram(),
     samplesNum(0),
+    momentaryPowerWeighted(0.0),
     momentaryLoudnessWeighted(0.0),
-    relativeThresholdWeighted(0.0),
-    integratedLoudnessWeighted(0.0)
+    integratedLoudnessWeighted(0.0),
+    shortTermPowerWeighted(0.0),
+    shortTermWeighted(0.0),
+    loudnessRange(0.0),
+    maxMomentaryLoudness(-std::numeric_limits<double>::infinity()),
+    maxShortTermLoudness(-std::numeric_limits<double>::infinity())
 {
-    int modifier = 1.0;
-    int a0 = 1.0;
-    filter1.setCoefficients(juce::IIRCoefficients(1.53512485958697, -2.69169618940638, 1.19839281085285, a0, -1.69065929318241 * modifier, 0.73248077421585 * modifier));
-    filter2.setCoefficients(juce::IIRCoefficients(1.0, -2.0, 1.0, a0, -1.99004745483398 * modifier, 0.99007225036621 * modifier));
+}
+
+void LufsCalculations::prepareToPlay(double sampleRate, int samplesPerBlock, const juce::AudioChannelSet& channelSet)
+{
+    // K-weighting has to match the sample rate, coefficients published in BS.1770 are valid only for 48kHz
+    filterCoefficients = KWeightingCoefficients::forSampleRate(sampleRate);
 
-    channels.push_back(LufsChannel(0, filter1, filter2));
-    channels.push_back(LufsChannel(1, filter1, filter2));
+    // Channels and their weights are built from the layout negotiated with the host
+    channels.prepareToPlay(sampleRate, samplesPerBlock, channelSet, filterCoefficients);
+    prepareCounters(channelSet.size());
 }
 
-void LufsCalculations::prepareToPlay(double sampleRate, int samplesPerBlock)
+void LufsCalculations::prepareToPlay(double sampleRate, int samplesPerBlock, const juce::Array<juce::AudioChannelSet::ChannelType>& channelTypes)
 {
-    //this->bin_length_in_samples = sampleRate / 10.0; // calcluate 100ms bin length
+    filterCoefficients = KWeightingCoefficients::forSampleRate(sampleRate);
+
+    channels.prepareToPlay(sampleRate, samplesPerBlock, channelTypes, filterCoefficients);
+    prepareCounters(channelTypes.size());
+}
 
+void LufsCalculations::prepareCounters(int channelsCount)
+{
+    prepared_channels_count = channelsCount;
+    channel_momentary_powers.assign(static_cast<size_t>(prepared_channels_count), 0.0);
+    channel_short_term_powers.assign(static_cast<size_t>(prepared_channels_count), 0.0);
 
-    for (ChannelIt = channels.begin(); ChannelIt != channels.end(); ++ChannelIt) {
-        ChannelIt->prepareToPlay(sampleRate, samplesPerBlock);
-    }
+    processed_bin_counter_for_momentary = LufsChannelBank::bins_in_400ms - 1;
+    processed_bin_counter_for_short_term = LufsChannelBank::bins_in_3s - 1;
 }
 
 void LufsCalculations::clearCounters()
@@ -49,30 +69,220 @@ void LufsCalculations::clearCounters()
     last_momentary_loudness->store(-std::numeric_limits<double>::infinity());
     integrated_loudness->store(-std::numeric_limits<double>::infinity());
     short_term_loudness->store(-std::numeric_limits<double>::infinity());
+    loudness_range->store(0.0f);
+
+    gating_histogram.clear();
+    loudness_range_histogram.clear();
+    momentaryLoudnessWeighted = -std::numeric_limits<double>::infinity();
+    shortTermWeighted = -std::numeric_limits<double>::infinity();
+    integratedLoudnessWeighted = -std::numeric_limits<double>::infinity();
+    loudnessRange = 0.0;
+    maxMomentaryLoudness = -std::numeric_limits<double>::infinity();
+    maxShortTermLoudness = -std::numeric_limits<double>::infinity();
+    std::fill(channel_momentary_powers.begin(), channel_momentary_powers.end(), 0.0);
+    std::fill(channel_short_term_powers.begin(), channel_short_term_powers.end(), 0.0);
+
+    channels.clearCounters();
+    processed_bin_counter_for_momentary = LufsChannelBank::bins_in_400ms - 1;
+    processed_bin_counter_for_short_term = LufsChannelBank::bins_in_3s - 1;
+    pre_roll_bins_count = 0;
+
+    sliding_bin_index = 0;
+    processed_sub_bins_count = 0;
+    momentary_dropped_square_sum = 0.0;
+    short_term_dropped_square_sum = 0.0;
+}
+
+void LufsCalculations::setUpdateInterval(int subBinsCount)
+{
+    jassert(subBinsCount > 0 && LufsChannelBank::sub_bins_per_bin % subBinsCount == 0); // updates have to line up with bins
+    update_interval_sub_bins.store(juce::jlimit(1, static_cast<int>(LufsChannelBank::sub_bins_per_bin), subBinsCount), std::memory_order_relaxed);
+}
+
+int LufsCalculations::getUpdateInterval() const
+{
+    return update_interval_sub_bins.load(std::memory_order_relaxed);
+}
+
+void LufsCalculations::setPreRoll(unsigned long long int binsCount)
+{
+    jassert(channels.getCompletedBinsCount() == 0); // pre roll has to start with the chunk
+    pre_roll_bins_count = binsCount;
+}
+
+unsigned int LufsCalculations::getBinLengthInSamples() const
+{
+    return channels.getBinLengthInSamples();
+}
+
+LufsPartialResult LufsCalculations::getPartialResult() const
+{
+    LufsPartialResult partialResult;
+    partialResult.gating_histogram = gating_histogram;
+    partialResult.loudness_range_histogram = loudness_range_histogram;
+    partialResult.max_momentary_loudness = maxMomentaryLoudness;
+    partialResult.max_short_term_loudness = maxShortTermLoudness;
+    return partialResult;
+}
+
+void LufsCalculations::mergePartialResult(const LufsPartialResult& partialResult)
+{
+    // Histograms keep every gated block, so merged gating is the same as if all blocks were measured by one object
+    gating_histogram.merge(partialResult.gating_histogram);
+    loudness_range_histogram.merge(partialResult.loudness_range_histogram);
+    maxMomentaryLoudness = std::max(maxMomentaryLoudness, partialResult.max_momentary_loudness);
+    maxShortTermLoudness = std::max(maxShortTermLoudness, partialResult.max_short_term_loudness);
+
+    integratedLoudnessWeighted = gating_histogram.calculateGatedLoudness(-10.0);
+    integrated_loudness->store(integratedLoudnessWeighted);
+
+    loudnessRange = loudness_range_histogram.calculateLoudnessRange(-20.0, 0.10, 0.95);
+    loudness_range->store(loudnessRange);
+}
+
+void LufsCalculations::writeState(juce::OutputStream& stream) const
+{
+    channels.writeState(stream);
+
+    stream.writeInt64(static_cast<juce::int64>(processed_bin_counter_for_momentary));
+    stream.writeInt64(static_cast<juce::int64>(processed_bin_counter_for_short_term));
+    stream.writeInt64(static_cast<juce::int64>(pre_roll_bins_count));
+
+    gating_histogram.writeState(stream);
+    loudness_range_histogram.writeState(stream);
+
+    stream.writeDouble(momentaryPowerWeighted);
+    stream.writeDouble(momentaryLoudnessWeighted);
+    stream.writeDouble(integratedLoudnessWeighted);
+    stream.writeDouble(shortTermPowerWeighted);
+    stream.writeDouble(shortTermWeighted);
+    stream.writeDouble(loudnessRange);
+    stream.writeDouble(maxMomentaryLoudness);
+    stream.writeDouble(maxShortTermLoudness);
+
+    stream.writeInt64(static_cast<juce::int64>(sliding_bin_index));
+    stream.writeInt(static_cast<int>(processed_sub_bins_count));
+    stream.writeDouble(momentary_dropped_square_sum);
+    stream.writeDouble(short_term_dropped_square_sum);
+}
 
-    for (ChannelIt = channels.begin(); ChannelIt != channels.end(); ++ChannelIt) {
-        ChannelIt->clearCounters();
+bool LufsCalculations::readState(juce::InputStream& stream)
+{
+    clearCounters();
+
+    if (!channels.readState(stream)) {
+        return false;
+    }
+
+    processed_bin_counter_for_momentary = static_cast<unsigned long long int>(stream.readInt64());
+    processed_bin_counter_for_short_term = static_cast<unsigned long long int>(stream.readInt64());
+    pre_roll_bins_count = static_cast<unsigned long long int>(stream.readInt64());
+
+    if (!gating_histogram.readState(stream) || !loudness_range_histogram.readState(stream) || stream.getNumBytesRemaining() < 8 * 8 + 28) {
+        clearCounters();
+        return false;
     }
+
+    momentaryPowerWeighted = stream.readDouble();
+    momentaryLoudnessWeighted = stream.readDouble();
+    integratedLoudnessWeighted = stream.readDouble();
+    shortTermPowerWeighted = stream.readDouble();
+    shortTermWeighted = stream.readDouble();
+    loudnessRange = stream.readDouble();
+    maxMomentaryLoudness = stream.readDouble();
+    maxShortTermLoudness = stream.readDouble();
+
+    sliding_bin_index = static_cast<unsigned long long int>(stream.readInt64());
+    processed_sub_bins_count = static_cast<unsigned int>(stream.readInt());
+    momentary_dropped_square_sum = stream.readDouble();
+    short_term_dropped_square_sum = stream.readDouble();
+
+    last_momentary_loudness->store(momentaryLoudnessWeighted);
+    short_term_loudness->store(shortTermWeighted);
+    integrated_loudness->store(integratedLoudnessWeighted);
+    loudness_range->store(loudnessRange);
+
+    calculateChannelPowers();
+    return true;
+}
+
+size_t LufsCalculations::getMaxStateSize() const
+{
+    return channels.getMaxStateSize() + 3 * 8 + 2 * LoudnessHistogram::getMaxStateSize() + 8 * 8 + 28;
+}
+
+void LufsCalculations::processBlock(const juce::AudioBuffer<float>& buffer, int channelCount)
+{
+    processBuffer(buffer, channelCount);
 }
 
-void LufsCalculations::processBlock(juce::AudioBuffer<float>& buffer, int channelCount)
+void LufsCalculations::processBlock(const juce::AudioBuffer<double>& buffer, int channelCount)
+{
+    processBuffer(buffer, channelCount);
+}
+
+template <typename SampleType>
+void LufsCalculations::processBuffer(const juce::AudioBuffer<SampleType>& buffer, int channelCount)
 {
     samplesNum = buffer.getNumSamples();
-    for (ChannelIt = channels.begin(); ChannelIt != channels.end(); ++ChannelIt) {
-        if (ChannelIt->channelNo >= channelCount) {
-            break;
+
+    if (channelCount < prepared_channels_count || buffer.getNumChannels() < prepared_channels_count) {
+        jassertfalse; // Block doesn't match layout from prepareToPlay
+        return;
+    }
+
+    processSamples(buffer.getArrayOfReadPointers());
+}
+
+void LufsCalculations::processInterleaved(const InterleavedPcm& pcm, int framesNum)
+{
+    samplesNum = framesNum;
+
+    if (pcm.frame_channels < prepared_channels_count) {
+        jassertfalse; // Data doesn't match layout from prepareToPlay
+        return;
+    }
+
+    processSamples(pcm);
+}
+
+template <typename Samples>
+void LufsCalculations::processSamples(const Samples& samples)
+{
+    // Block is split at sub bin boundaries, so every bin and sub bin is processed right after it is filled.
+    // Thanks to that channels only need to keep the last 3s of bins, no matter how big the block is.
+    int start_sample = 0;
+    while (start_sample < samplesNum) {
+        int chunk_length = std::min(samplesNum - start_sample, static_cast<int>(channels.getSamplesLeftInFillingSubBin()));
+        if (chunk_length <= 0) {
+            jassertfalse; // prepareToPlay was not called
+            return;
         }
 
-        float* write_pointer = buffer.getWritePointer(ChannelIt->channelNo);
-        ChannelIt->fillBins(write_pointer, samplesNum);
+        channels.fillBins(samples, start_sample, chunk_length);
+        start_sample += chunk_length;
+
+        processFilledBins();
     }
+}
 
+void LufsCalculations::processFilledBins()
+{
+    bool new_momentary_loudness = false;
 
-    // if there is enough NEW bins (at least 400ms of data and at leas 100ms of NEW data) for momentary lufs calculation in EACH channel
-    while (isEnoughForMomentaryInEachChannel()) {
+    // if there is enough NEW bins (at least 400ms of data and at leas 100ms of NEW data) for momentary lufs calculation
+    while (isEnoughForMomentary()) {
+
+        // block ends in pre roll - skip it
+        if (processed_bin_counter_for_momentary < pre_roll_bins_count) {
+            processed_bin_counter_for_momentary++;
+            continue;
+        }
 
         // calculate momentary loudness weighted for channels:
         this->calculateMomentaryLoudnessWeighted();
+        new_momentary_loudness = true;
+        maxMomentaryLoudness = std::max(maxMomentaryLoudness, momentaryLoudnessWeighted);
 
         // if momentary loudness passes gate 1:
         if (momentaryLoudnessWeighted > -70.0) {
@@ -80,105 +290,199 @@ void LufsCalculations::processBlock(juce::AudioBuffer<float>& buffer, int channe
             // store and display it:
             last_momentary_loudness->store(momentaryLoudnessWeighted);
 
-            // calculate relative threshold for gate 2:
-            this->calculateRelativeThresholdWeighted();
-
-            // check if all channels pass the gate:
-            if (this->relativeThresholdGateForEachChannel()) {
+            // remember block for gating, relative threshold (gate 2) is applied by the histogram:
+            gating_histogram.addBlock(momentaryPowerWeighted);
 
-                // calculate integrated loduness and store it, display it:
-                this->calculateIntegratedLoudnessWeighted();
-                integrated_loudness->store(integratedLoudnessWeighted);
-            }
+            // calculate integrated loduness and store it, display it:
+            integratedLoudnessWeighted = gating_histogram.calculateGatedLoudness(-10.0);
+            integrated_loudness->store(integratedLoudnessWeighted);
         }
 
     }
 
-    while (isEnoughForShortTermInEachChannel()) {
+    while (isEnoughForShortTerm()) {
+        if (processed_bin_counter_for_short_term < pre_roll_bins_count) {
+            processed_bin_counter_for_short_term++;
+            continue;
+        }
+
         this->calculateShortTermLoudnessWeighted();
-        short_term_loudness->store(integratedLoudnessWeighted);
+        short_term_loudness->store(shortTermWeighted);
+        maxShortTermLoudness = std::max(maxShortTermLoudness, shortTermWeighted);
+
+        // Loudness range (EBU Tech 3342) - short term blocks gated at -70 LUFS and -20 LU,
+        // difference between 95th and 10th percentile of their loudness
+        loudness_range_histogram.addBlock(shortTermPowerWeighted);
+        loudnessRange = loudness_range_histogram.calculateLoudnessRange(-20.0, 0.10, 0.95);
+        loudness_range->store(loudnessRange);
     }
+
+    // Blocks are split at bin boundaries, so there is at most one new bin here
+    if (history != nullptr && new_momentary_loudness) {
+        const bool has_short_term = processed_bin_counter_for_short_term >= LufsChannelBank::bins_in_3s;
+        history->push({ static_cast<float>(momentaryLoudnessWeighted),
+                        has_short_term ? static_cast<float>(shortTermWeighted) : -std::numeric_limits<float>::infinity() });
+    }
+
+    processFilledSubBins();
 }
 
-bool LufsCalculations::isEnoughForMomentaryInEachChannel()
+void LufsCalculations::processFilledSubBins()
 {
-    bool temp_condition = true;
-    for (ChannelIt = channels.begin(); ChannelIt != channels.end(); ++ChannelIt) {
-        bool tt_cond = ChannelIt->isEnoughForMomentary();
-        temp_condition = temp_condition && tt_cond;
+    const int update_interval = update_interval_sub_bins.load(std::memory_order_relaxed);
+    if (update_interval >= LufsChannelBank::sub_bins_per_bin) {
+        return; // Updated only with bins
+    }
+
+    const unsigned long long int filling_bin = channels.getCompletedBinsCount();
+    if (filling_bin != sliding_bin_index) {
+        // New bin - windows start from the values calculated for the bin that was just completed
+        sliding_bin_index = filling_bin;
+        processed_sub_bins_count = 0;
+        momentary_dropped_square_sum = 0.0;
+        short_term_dropped_square_sum = 0.0;
+    }
+
+    const unsigned int completed_sub_bins = channels.getCompletedSubBinsInFillingBin();
+    if (completed_sub_bins == processed_sub_bins_count) {
+        return; // Block ended inside of a sub bin
+    }
+
+    const bool momentary_sliding = isMomentarySliding();
+    const bool short_term_sliding = isShortTermSliding();
+
+    // Blocks are split at sub bin boundaries, so this is one sub bin - O(1) per update
+    while (processed_sub_bins_count < completed_sub_bins) {
+        if (momentary_sliding) {
+            momentary_dropped_square_sum += channels.calculateWeightedSubBinSquareSum(filling_bin - LufsChannelBank::bins_in_400ms, processed_sub_bins_count);
+        }
+        if (short_term_sliding) {
+            short_term_dropped_square_sum += channels.calculateWeightedSubBinSquareSum(filling_bin - LufsChannelBank::bins_in_3s, processed_sub_bins_count);
+        }
+        processed_sub_bins_count++;
+    }
+
+    if (processed_sub_bins_count % update_interval != 0 || (!momentary_sliding && !short_term_sliding)) {
+        return;
+    }
+
+    const double filling_square_sum = channels.calculateWeightedFillingSquareSum();
+    const double bin_length = static_cast<double>(channels.getBinLengthInSamples());
+
+    if (momentary_sliding) {
+        const double power = momentaryPowerWeighted + (filling_square_sum - momentary_dropped_square_sum) / (LufsChannelBank::bins_in_400ms * bin_length);
+        momentaryLoudnessWeighted = LoudnessHistogram::powerToLoudness(std::max(power, 0.0));
+        if (momentaryLoudnessWeighted > -70.0) {
+            last_momentary_loudness->store(momentaryLoudnessWeighted);
+        }
+    }
+
+    if (short_term_sliding) {
+        const double power = shortTermPowerWeighted + (filling_square_sum - short_term_dropped_square_sum) / (LufsChannelBank::bins_in_3s * bin_length);
+        shortTermWeighted = LoudnessHistogram::powerToLoudness(std::max(power, 0.0));
+        short_term_loudness->store(shortTermWeighted);
     }
-    return temp_condition;
 }
 
-void LufsCalculations::calculateMomentaryLoudnessWeighted()
+bool LufsCalculations::isMomentarySliding() const
 {
-    momentaryLoudnessWeighted = 0.0;
-    for (ChannelIt = channels.begin(); ChannelIt != channels.end(); ++ChannelIt) {
+    // Window that ended with the last bin was measured (not in pre roll, not before the first 400ms)
+    const unsigned long long int filling_bin = channels.getCompletedBinsCount();
+    return filling_bin >= LufsChannelBank::bins_in_400ms && processed_bin_counter_for_momentary == filling_bin && filling_bin > pre_roll_bins_count;
+}
 
-        // calculate momentary rms weighted for channels
-        // momentary rms = sum of squares of samples in last 400ms /no. of samples in 400ms
-        momentaryLoudnessWeighted += ChannelIt->calculateMomentaryRmsForChannel() * ChannelIt->Weight;
-    }
+bool LufsCalculations::isShortTermSliding() const
+{
+    const unsigned long long int filling_bin = channels.getCompletedBinsCount();
+    return filling_bin >= LufsChannelBank::bins_in_3s && processed_bin_counter_for_short_term == filling_bin && filling_bin > pre_roll_bins_count;
+}
 
-    // calculate momentary loudness based on momentary RMS
-    momentaryLoudnessWeighted = -0.691 + 10 * std::log10(momentaryLoudnessWeighted);
+double LufsCalculations::getMaxMomentaryLoudness() const
+{
+    return maxMomentaryLoudness;
 }
 
-void LufsCalculations::calculateRelativeThresholdWeighted()
+double LufsCalculations::getMaxShortTermLoudness() const
 {
-    relativeThresholdWeighted = 0.0;
-    for (ChannelIt = channels.begin(); ChannelIt != channels.end(); ++ChannelIt) {
+    return maxShortTermLoudness;
+}
 
-        // rmses for second gate: momentary rmses from the beginning of measurement are avergaed and weighted for each channel
-        relativeThresholdWeighted += ChannelIt->calculateRmsForRelativeThreshold() * ChannelIt->Weight;
-    }
+double LufsCalculations::getMomentaryLoudness() const
+{
+    return momentaryLoudnessWeighted;
+}
 
-    // relative threshold is calculated based on average of momentary RMSes
-    relativeThresholdWeighted = -10.691 + 10.0 * std::log10(relativeThresholdWeighted);
+double LufsCalculations::getShortTermLoudness() const
+{
+    return shortTermWeighted;
 }
 
-bool LufsCalculations::relativeThresholdGateForEachChannel()
+double LufsCalculations::getIntegratedLoudness() const
 {
-    // each channel needs to pass second (relative threshold) gate.
-    // their last momentary RMSes must be higher than calculated relative threshold
-    bool temp_threshold_passed = true;
-    for (ChannelIt = channels.begin(); ChannelIt != channels.end(); ++ChannelIt) {
-        temp_threshold_passed = temp_threshold_passed && ChannelIt->relativeThresholdGate(relativeThresholdWeighted);
-    }
-    return temp_threshold_passed;
+    return integratedLoudnessWeighted;
 }
 
-void LufsCalculations::calculateIntegratedLoudnessWeighted()
+double LufsCalculations::getLoudnessRange() const
 {
-    integratedLoudnessWeighted = 0.0;
-    for (ChannelIt = channels.begin(); ChannelIt != channels.end(); ++ChannelIt) {
+    return loudnessRange;
+}
 
-        //accumulate all momentary rmses that passed both gates and average them. 
-        integratedLoudnessWeighted += ChannelIt->calculateAverageOfMomentaryPowerSegments() * ChannelIt->Weight;
-    }
+int LufsCalculations::getChannelsCount() const
+{
+    return prepared_channels_count;
+}
+
+double LufsCalculations::getChannelMomentaryLoudness(int channel) const
+{
+    return LoudnessHistogram::powerToLoudness(channel_momentary_powers[static_cast<size_t>(channel)]);
+}
 
-    //based on that average we can calulate channel weighted integrated loudness
-    integratedLoudnessWeighted = -0.691 + 10.0 * std::log10(integratedLoudnessWeighted);
+double LufsCalculations::getChannelShortTermLoudness(int channel) const
+{
+    return LoudnessHistogram::powerToLoudness(channel_short_term_powers[static_cast<size_t>(channel)]);
 }
 
-bool LufsCalculations::isEnoughForShortTermInEachChannel()
+void LufsCalculations::calculateChannelPowers()
 {
-    bool temp_condition = true;
-    for (ChannelIt = channels.begin(); ChannelIt != channels.end(); ++ChannelIt) {
-        bool tt_cond = ChannelIt->isEnoughForShortTerm();
-        temp_condition = temp_condition && tt_cond;
+    // Counters point to the next window, windows are in the ring only if at least one was calculated
+    if (processed_bin_counter_for_momentary >= LufsChannelBank::bins_in_400ms) {
+        channels.calculateChannelPowers(processed_bin_counter_for_momentary - 1, LufsChannelBank::bins_in_400ms, channel_momentary_powers.data());
+    }
+    if (processed_bin_counter_for_short_term >= LufsChannelBank::bins_in_3s) {
+        channels.calculateChannelPowers(processed_bin_counter_for_short_term - 1, LufsChannelBank::bins_in_3s, channel_short_term_powers.data());
     }
-    return temp_condition;
 }
 
-void LufsCalculations::calculateShortTermLoudnessWeighted()
+bool LufsCalculations::isEnoughForMomentary()
 {
-    shortTermWeighted = 0.0;
-    for (ChannelIt = channels.begin(); ChannelIt != channels.end(); ++ChannelIt) {
+    // Proceed to any LUFS calculation ONLY if new bin was added (and there is AT LEAST default 4 bins stored)
+    // processed_bin_counter starts at 3, so adding FULL 4th bin will cause this while to be called for the first time.
+    return channels.getCompletedBinsCount() > processed_bin_counter_for_momentary;
+}
 
-        shortTermWeighted += ChannelIt->calculateShortTermRmsForChannel() * ChannelIt->Weight;
-    }
+void LufsCalculations::calculateMomentaryLoudnessWeighted()
+{
+    // calculate momentary rms weighted for channels
+    // momentary rms = sum of squares of samples in last 400ms /no. of samples in 400ms
+    // Also called momentary power of segment
+    momentaryPowerWeighted = channels.calculateWeightedPower(processed_bin_counter_for_momentary, LufsChannelBank::bins_in_400ms);
+    channels.calculateChannelPowers(processed_bin_counter_for_momentary, LufsChannelBank::bins_in_400ms, channel_momentary_powers.data());
+    processed_bin_counter_for_momentary++; // New bin is being processed - increase the amount of bins processed
 
-    shortTermWeighted = -0.691 + 10 * std::log10(shortTermWeighted);
+    // calculate momentary loudness based on momentary RMS
+    momentaryLoudnessWeighted = LoudnessHistogram::powerToLoudness(momentaryPowerWeighted);
 }
 
+bool LufsCalculations::isEnoughForShortTerm()
+{
+    return channels.getCompletedBinsCount() > processed_bin_counter_for_short_term;
+}
+
+void LufsCalculations::calculateShortTermLoudnessWeighted()
+{
+    shortTermPowerWeighted = channels.calculateWeightedPower(processed_bin_counter_for_short_term, LufsChannelBank::bins_in_3s);
+    channels.calculateChannelPowers(processed_bin_counter_for_short_term, LufsChannelBank::bins_in_3s, channel_short_term_powers.data());
+    processed_bin_counter_for_short_term++;
+
+    shortTermWeighted = LoudnessHistogram::powerToLoudness(shortTermPowerWeighted);
+}
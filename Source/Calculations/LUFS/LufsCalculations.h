@@ -11,43 +11,158 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "LufsChannel.h"
+#include "LufsChannelBank.h"
+#include "LoudnessHistogram.h"
+#include "LoudnessHistoryFifo.h"
+
+// Everything needed to join measurements of consecutive chunks of one file into integrated loudness and loudness range
+struct LufsPartialResult {
+    LoudnessHistogram gating_histogram;
+    LoudnessHistogram loudness_range_histogram;
+    double max_momentary_loudness = -std::numeric_limits<double>::infinity();
+    double max_short_term_loudness = -std::numeric_limits<double>::infinity();
+};
 
 class LufsCalculations {
 public:
     LufsCalculations();
 
-    void prepareToPlay(double sampleRate, int samplesPerBlock);
+    void prepareToPlay(double sampleRate, int samplesPerBlock, const juce::AudioChannelSet& channelSet);
+
+    // Type of every channel in buffer order, for interleaved files whose channels are not in AudioChannelSet order
+    void prepareToPlay(double sampleRate, int samplesPerBlock, const juce::Array<juce::AudioChannelSet::ChannelType>& channelTypes);
 
     void clearCounters();
 
-    void processBlock(juce::AudioBuffer<float>& buffer, int channelCount);
+    void processBlock(const juce::AudioBuffer<float>& buffer, int channelCount);
+    void processBlock(const juce::AudioBuffer<double>& buffer, int channelCount);
+
+    // Offline analysis of memory mapped files - pcm.data points to the first of framesNum frames of the block
+    void processInterleaved(const InterleavedPcm& pcm, int framesNum);
+
+    // How often momentary and short term loudness are updated, in sub bins (10ms): 1, 2, 5 or 10 (default, once per bin).
+    // Windows slide by whole sub bins, each update costs the same no matter how short the interval is.
+    // Gating, loudness range and maximal values still use blocks starting every 100ms (BS.1770, EBU Tech 3342).
+    // Can be changed from any thread.
+    void setUpdateInterval(int subBinsCount);
+    int getUpdateInterval() const;
+
+    // Chunked measurement: chunk starts binsCount bins (at least bins_in_3s + filter settling time) before the part it measures.
+    // Blocks ending in these bins only warm up filters and fill the ring - they are not added to any result.
+    // Must be called after clearCounters.
+    void setPreRoll(unsigned long long int binsCount);
+
+    // Chunks have to start at bin boundaries, so that their bins are the same as bins of a single pass
+    unsigned int getBinLengthInSamples() const;
+
+    // Partial result of this chunk, not meant for audio thread (it copies histograms)
+    LufsPartialResult getPartialResult() const;
+
+    // Adds blocks measured by another chunk and publishes integrated loudness and loudness range of both
+    void mergePartialResult(const LufsPartialResult& partialResult);
+
+    // Whole measurement (channel bank, counters, histograms, last values), so that it can continue after reload.
+    // Neither allocates - stream has to write to / read from memory prepared in advance.
+    // readState returns false and clears counters if state doesn't match the prepared channels and sample rate.
+    void writeState(juce::OutputStream& stream) const;
+    bool readState(juce::InputStream& stream);
+    size_t getMaxStateSize() const;
+
+    // Highest values since last clearCounters (for offline analysis, where only the summary is printed)
+    double getMaxMomentaryLoudness() const;
+    double getMaxShortTermLoudness() const;
+
+    // Last calculated values in full precision, for the telemetry snapshot - audio thread only
+    double getMomentaryLoudness() const;
+    double getShortTermLoudness() const;
+    double getIntegratedLoudness() const;
+    double getLoudnessRange() const;
+
+    // Momentary and short term loudness of a single channel on its own (without channel weight), updated every bin (100ms).
+    // Channels not measured by LUFS (LFE) stay at -inf.
+    int getChannelsCount() const;
+    double getChannelMomentaryLoudness(int channel) const;
+    double getChannelShortTermLoudness(int channel) const;
 
     std::atomic<float>* last_momentary_loudness = nullptr;
     std::atomic<float>* integrated_loudness = nullptr;
     std::atomic<float>* short_term_loudness = nullptr;
+    std::atomic<float>* loudness_range = nullptr;
+
+    // Momentary and short term loudness of every bin, for the editor graph (optional)
+    LoudnessHistoryFifo* history = nullptr;
 
 private:
-    bool isEnoughForMomentaryInEachChannel();
-    bool relativeThresholdGateForEachChannel();
+    // Per channel values and bin counters for channelsCount channels of the buffer
+    void prepareCounters(int channelsCount);
+
+    template <typename SampleType>
+    void processBuffer(const juce::AudioBuffer<SampleType>& buffer, int channelCount);
+
+    // Samples - anything LufsChannelBank::fillBins accepts
+    template <typename Samples>
+    void processSamples(const Samples& samples);
+
+    void processFilledBins();
+
+    // Slides momentary and short term windows over new sub bins of the bin being filled
+    void processFilledSubBins();
+    bool isMomentarySliding() const;
+    bool isShortTermSliding() const;
+
+    bool isEnoughForMomentary();
     void calculateMomentaryLoudnessWeighted();
-    void calculateRelativeThresholdWeighted();
-    void calculateIntegratedLoudnessWeighted();
 
-    bool isEnoughForShortTermInEachChannel();
+    bool isEnoughForShortTerm();
     void calculateShortTermLoudnessWeighted();
 
-    juce::IIRFilter filter1;
-    juce::IIRFilter filter2;
+    // Per channel powers of the last windows that momentary and short term loudness were calculated from
+    void calculateChannelPowers();
+
+    KWeightingCoefficients filterCoefficients;
+
+    LufsChannelBank channels;
+    int prepared_channels_count;
+
+    // Per channel mean squares, indexed like channels of the host buffer - allocated in prepareToPlay
+    std::vector<double> channel_momentary_powers;
+    std::vector<double> channel_short_term_powers;
 
+    // counters of already processed bins. Processing starts at bin bins_in_400ms (value 4), so default is bins_in_400ms-1 (value 3)
+    unsigned long long int processed_bin_counter_for_momentary = LufsChannelBank::bins_in_400ms - 1;
+    unsigned long long int processed_bin_counter_for_short_term = LufsChannelBank::bins_in_3s - 1;
 
-    std::list<LufsChannel> channels;
+    // Blocks ending before this bin are not measured (see setPreRoll)
+    unsigned long long int pre_roll_bins_count = 0;
 
-    // temp variables!
-    std::list<LufsChannel>::iterator ChannelIt;
+    std::atomic<int> update_interval_sub_bins;
+
+    // Sliding windows between bins: power of the window that ended with the last bin (momentaryPowerWeighted, shortTermPowerWeighted)
+    // + sub bins of the filling bin - the same number of sub bins from the start of the oldest bin of the window.
+    // Every bin starts again from the exact value, so rounding errors never accumulate.
+    unsigned long long int sliding_bin_index = 0; // Bin being filled, that the values below belong to
+    unsigned int processed_sub_bins_count = 0;
+    double momentary_dropped_square_sum = 0.0;
+    double short_term_dropped_square_sum = 0.0;
+
+    // Momentary powers of all blocks that passed gate 1, for two-pass gating of integrated loudness
+    LoudnessHistogram gating_histogram;
+
+    // Short term powers of all 3s blocks that passed gate 1, for loudness range
+    LoudnessHistogram loudness_range_histogram;
+
+    // Length of the block being processed
     int samplesNum;
+
+    // Last calculated values, channel weighted (see getLast... getters)
+    double momentaryPowerWeighted;
     double momentaryLoudnessWeighted;
-    double relativeThresholdWeighted;
     double integratedLoudnessWeighted;
+    double shortTermPowerWeighted;
     double shortTermWeighted;
-};
\ No newline at end of file
+    double loudnessRange;
+
+    // Highest values since last clearCounters
+    double maxMomentaryLoudness;
+    double maxShortTermLoudness;
+};
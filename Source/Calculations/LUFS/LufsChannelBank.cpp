@@ -0,0 +1,613 @@
+/*
+  ==============================================================================
+
+    LufsChannelBank.cpp
+    Created: 7 Jan 2024 12:51:47pm
+    Author:  kubam
+
+  ==============================================================================
+*/
+
+#include "LufsChannelBank.h"
+
+namespace {
+    // Sample sources - each one gives a Lane (position of a channel at start_sample) and reads sample i of it.
+    // Samples are multiplied by scale afterwards, inside of the kernel. Sample is the type the kernel filters them in.
+
+    // Planar float, as in host buffers
+    struct PlanarFloatSource {
+        using Lane = const float*;
+        using Sample = float;
+        static constexpr float scale = 1.0f;
+
+        const float* const* channel_data;
+
+        Lane getLane(int channel, int start_sample) const { return channel_data[channel] + start_sample; }
+        float read(Lane lane, int i) const { return lane[i]; }
+    };
+
+    // Planar double, as in hosts processing in double precision
+    struct PlanarDoubleSource {
+        using Lane = const double*;
+        using Sample = double;
+        static constexpr float scale = 1.0f;
+
+        const double* const* channel_data;
+
+        Lane getLane(int channel, int start_sample) const { return channel_data[channel] + start_sample; }
+        double read(Lane lane, int i) const { return lane[i]; }
+    };
+
+    // Interleaved PCM. WAV is little endian, and its chunks are aligned to 2 bytes only - samples are read byte by byte
+    // (compilers turn it into single unaligned load where the target allows it).
+    struct InterleavedInt16Source {
+        using Lane = const juce::uint8*;
+        using Sample = float;
+        static constexpr float scale = 1.0f / 32768.0f;
+
+        const juce::uint8* data;
+        int frame_channels;
+
+        Lane getLane(int channel, int start_sample) const { return data + (static_cast<size_t>(start_sample) * frame_channels + channel) * 2; }
+        float read(Lane lane, int i) const { return static_cast<float>(static_cast<juce::int16>(juce::ByteOrder::littleEndianShort(lane + i * frame_channels * 2))); }
+    };
+
+    struct InterleavedInt24Source {
+        using Lane = const juce::uint8*;
+        using Sample = float;
+        static constexpr float scale = 1.0f / 8388608.0f;
+
+        const juce::uint8* data;
+        int frame_channels;
+
+        Lane getLane(int channel, int start_sample) const { return data + (static_cast<size_t>(start_sample) * frame_channels + channel) * 3; }
+        float read(Lane lane, int i) const { return static_cast<float>(juce::ByteOrder::littleEndian24Bit(lane + i * frame_channels * 3)); }
+    };
+
+    struct InterleavedFloatSource {
+        using Lane = const juce::uint8*;
+        using Sample = float;
+        static constexpr float scale = 1.0f;
+
+        const juce::uint8* data;
+        int frame_channels;
+
+        Lane getLane(int channel, int start_sample) const { return data + (static_cast<size_t>(start_sample) * frame_channels + channel) * 4; }
+        float read(Lane lane, int i) const
+        {
+            const juce::uint32 bits = juce::ByteOrder::littleEndianInt(lane + i * frame_channels * 4);
+            float sample;
+            memcpy(&sample, &bits, sizeof(sample));
+            return sample;
+        }
+    };
+}
+
+LufsChannelBank::LufsChannelBank() :
+    channel_numbers(),
+    weights(),
+    groups_count(0),
+    high_shelf_z1(),
+    high_shelf_z2(),
+    high_pass_z1(),
+    high_pass_z2(),
+    lane_weights(),
+    filling_bin_square_sums(),
+    lanes_count(0),
+    bin_rms_container(),
+    sub_bin_square_sums(),
+    sub_bin_start_square_sums(),
+    bin_length_in_samples(0),
+    filterCoefficients(),
+    use_filters(true)
+{
+}
+
+void LufsChannelBank::prepareToPlay(double sampleRate, int samplesPerBlock, const juce::AudioChannelSet& channelSet, const KWeightingCoefficients& filter_coefficients)
+{
+    juce::ignoreUnused(samplesPerBlock);
+
+    std::vector<float> channel_weights;
+    for (int channel = 0; channel < channelSet.size(); channel++) {
+        channel_weights.push_back(getChannelWeight(channelSet, channel));
+    }
+    prepareChannels(sampleRate, channel_weights, filter_coefficients);
+}
+
+void LufsChannelBank::prepareToPlay(double sampleRate, int samplesPerBlock, const juce::Array<juce::AudioChannelSet::ChannelType>& channelTypes, const KWeightingCoefficients& filter_coefficients)
+{
+    juce::ignoreUnused(samplesPerBlock);
+
+    std::vector<float> channel_weights;
+    for (const juce::AudioChannelSet::ChannelType type : channelTypes) {
+        channel_weights.push_back(getChannelWeight(type));
+    }
+    prepareChannels(sampleRate, channel_weights, filter_coefficients);
+}
+
+void LufsChannelBank::prepareChannels(double sampleRate, const std::vector<float>& channel_weights, const KWeightingCoefficients& filter_coefficients)
+{
+    this->bin_length_in_samples = static_cast<unsigned int>(sampleRate / 10.0); // calcluate 100ms bin length
+    this->filterCoefficients = filter_coefficients;
+
+    channel_numbers.clear();
+    weights.clear();
+    for (int channel = 0; channel < static_cast<int>(channel_weights.size()); channel++) {
+        const float weight = channel_weights[static_cast<size_t>(channel)];
+        if (weight > 0.0f) {
+            channel_numbers.push_back(channel);
+            weights.push_back(weight);
+        }
+    }
+
+    const int lanes = static_cast<int>(SIMDFloat::size());
+    groups_count = (static_cast<int>(channel_numbers.size()) + lanes - 1) / lanes;
+
+    lanes_count = groups_count * lanes;
+
+    lane_weights.assign(lanes_count, 0.0);
+    for (size_t channel = 0; channel < weights.size(); channel++) {
+        lane_weights[channel] = weights[channel];
+    }
+
+    high_shelf_z1.assign(lanes_count, 0.0);
+    high_shelf_z2.assign(lanes_count, 0.0);
+    high_pass_z1.assign(lanes_count, 0.0);
+    high_pass_z2.assign(lanes_count, 0.0);
+    filling_bin_square_sums.assign(lanes_count, 0.0);
+
+    // Short term loudness (3s) is the longest window that needs bins, so only the last bins_in_3s bins are kept.
+    // Ring is allocated here once, audio thread only overwrites it.
+    bin_rms_container.assign(bins_in_3s * lanes_count, 0.0);
+    sub_bin_square_sums.assign((bins_in_3s + 1) * sub_bins_per_bin * lanes_count, 0.0);
+    sub_bin_start_square_sums.assign(lanes_count, 0.0);
+    bin_write_position = 0;
+    completed_bins_count = 0;
+    current_position_in_filling_bin = 0;
+    completed_sub_bins_in_filling_bin = 0;
+}
+
+void LufsChannelBank::clearCounters()
+{
+    std::fill(high_shelf_z1.begin(), high_shelf_z1.end(), 0.0);
+    std::fill(high_shelf_z2.begin(), high_shelf_z2.end(), 0.0);
+    std::fill(high_pass_z1.begin(), high_pass_z1.end(), 0.0);
+    std::fill(high_pass_z2.begin(), high_pass_z2.end(), 0.0);
+    std::fill(filling_bin_square_sums.begin(), filling_bin_square_sums.end(), 0.0);
+    std::fill(bin_rms_container.begin(), bin_rms_container.end(), 0.0);
+    std::fill(sub_bin_square_sums.begin(), sub_bin_square_sums.end(), 0.0);
+    std::fill(sub_bin_start_square_sums.begin(), sub_bin_start_square_sums.end(), 0.0);
+    bin_write_position = 0;
+    completed_bins_count = 0;
+    current_position_in_filling_bin = 0;
+    completed_sub_bins_in_filling_bin = 0;
+}
+
+void LufsChannelBank::fillBins(const float* const* channel_data, int start_sample, int samplesNum)
+{
+    fillBinsFrom(PlanarFloatSource{ channel_data }, start_sample, samplesNum);
+}
+
+void LufsChannelBank::fillBins(const double* const* channel_data, int start_sample, int samplesNum)
+{
+    fillBinsFrom(PlanarDoubleSource{ channel_data }, start_sample, samplesNum);
+}
+
+void LufsChannelBank::fillBins(const InterleavedPcm& pcm, int start_sample, int samplesNum)
+{
+    switch (pcm.format) {
+    case InterleavedPcm::SampleFormat::int16:
+        fillBinsFrom(InterleavedInt16Source{ static_cast<const juce::uint8*>(pcm.data), pcm.frame_channels }, start_sample, samplesNum);
+        break;
+    case InterleavedPcm::SampleFormat::int24:
+        fillBinsFrom(InterleavedInt24Source{ static_cast<const juce::uint8*>(pcm.data), pcm.frame_channels }, start_sample, samplesNum);
+        break;
+    case InterleavedPcm::SampleFormat::float32:
+        fillBinsFrom(InterleavedFloatSource{ static_cast<const juce::uint8*>(pcm.data), pcm.frame_channels }, start_sample, samplesNum);
+        break;
+    }
+}
+
+template <typename SampleSource>
+void LufsChannelBank::fillBinsFrom(const SampleSource& source, int start_sample, int samplesNum)
+{
+    jassert(bin_length_in_samples > 0); // prepareToPlay was not called
+
+    // Samples are split at sub bin boundaries, so the kernel itself doesn't need to check for the end of the bin.
+    while (samplesNum > 0) {
+        int part_length = std::min(samplesNum, static_cast<int>(getSamplesLeftInFillingSubBin()));
+
+        filterAndAccumulate(source, start_sample, part_length);
+        current_position_in_filling_bin += part_length;
+
+        if (current_position_in_filling_bin >= getSubBinEnd(completed_sub_bins_in_filling_bin)) {
+            completeSubBin();
+        }
+
+        if (current_position_in_filling_bin >= bin_length_in_samples) {
+            current_position_in_filling_bin = 0;
+            completed_sub_bins_in_filling_bin = 0;
+
+            // Bin is full - overwrite the oldest one in the ring
+            double* bin = &bin_rms_container[bin_write_position * lanes_count];
+            for (int lane = 0; lane < lanes_count; lane++) {
+                bin[lane] = filling_bin_square_sums[lane] / bin_length_in_samples;
+                filling_bin_square_sums[lane] = 0.0;
+                sub_bin_start_square_sums[lane] = 0.0;
+            }
+            completed_bins_count++;
+
+            bin_write_position++;
+            if (bin_write_position >= bins_in_3s) {
+                bin_write_position = 0;
+            }
+        }
+
+        start_sample += part_length;
+        samplesNum -= part_length;
+    }
+}
+
+template <typename SampleSource>
+void LufsChannelBank::filterAndAccumulate(const SampleSource& source, int start_sample, int samplesNum)
+{
+    using SIMDType = juce::dsp::SIMDRegister<typename SampleSource::Sample>;
+    static_assert(SIMDFloat::size() % SIMDType::size() == 0, "Lanes of float groups have to split into registers of the kernel");
+    const int registers_count = lanes_count / static_cast<int>(SIMDType::size());
+
+    // Common layouts have all their registers filtered in a single pass over samples (with 4 lane float registers:
+    // mono, stereo - 1 register, 5.1, 7.1 - 2 registers, 7.1.4 - 3 registers; 2 lane double registers need twice as many).
+    // Filters of one register are a chain of dependent operations, filters of other registers run in between them.
+    // Bigger layouts are filtered register after register - more of them would not fit into the register file.
+    switch (registers_count) {
+    case 1:
+        filterAndAccumulateGroups<SIMDType, 1>(source, start_sample, samplesNum, 0);
+        break;
+    case 2:
+        filterAndAccumulateGroups<SIMDType, 2>(source, start_sample, samplesNum, 0);
+        break;
+    case 3:
+        filterAndAccumulateGroups<SIMDType, 3>(source, start_sample, samplesNum, 0);
+        break;
+    default:
+        for (int group = 0; group < registers_count; group++) {
+            filterAndAccumulateGroups<SIMDType, 1>(source, start_sample, samplesNum, group);
+        }
+        break;
+    }
+}
+
+template <typename SIMDType, int GroupsCount, typename SampleSource>
+void LufsChannelBank::filterAndAccumulateGroups(const SampleSource& source, int start_sample, int samplesNum, int first_group)
+{
+    // Both filter stages and squaring are done in a single pass over samples, for GroupsCount * SIMDType::size() channels at once.
+    // Filters are linear, so scale of integer samples is applied by multiplying b coefficients of the first stage.
+    // Loops over groups have constant length, so compiler unrolls them and keeps the whole state in registers.
+    using Sample = typename SIMDType::ElementType;
+    constexpr int lanes = static_cast<int>(SIMDType::size());
+    const int channels_count = static_cast<int>(channel_numbers.size());
+
+    const BiquadCoefficients& shelf = filterCoefficients.high_shelf;
+    const BiquadCoefficients& pass = filterCoefficients.high_pass;
+    const Sample scale = static_cast<Sample>(SampleSource::scale);
+    const SIMDType input_scale = SIMDType::expand(scale);
+    const SIMDType shelf_b0 = SIMDType::expand(static_cast<Sample>(shelf.b0) * scale);
+    const SIMDType shelf_b1 = SIMDType::expand(static_cast<Sample>(shelf.b1) * scale);
+    const SIMDType shelf_b2 = SIMDType::expand(static_cast<Sample>(shelf.b2) * scale);
+    const SIMDType shelf_a1 = SIMDType::expand(static_cast<Sample>(shelf.a1)), shelf_a2 = SIMDType::expand(static_cast<Sample>(shelf.a2));
+    const SIMDType pass_b0 = SIMDType::expand(static_cast<Sample>(pass.b0)), pass_b1 = SIMDType::expand(static_cast<Sample>(pass.b1));
+    const SIMDType pass_b2 = SIMDType::expand(static_cast<Sample>(pass.b2));
+    const SIMDType pass_a1 = SIMDType::expand(static_cast<Sample>(pass.a1)), pass_a2 = SIMDType::expand(static_cast<Sample>(pass.a2));
+
+    typename SampleSource::Lane lane_data[GroupsCount][lanes];
+
+    for (int g = 0; g < GroupsCount; g++) {
+        for (int lane = 0; lane < lanes; lane++) {
+            int channel = std::min((first_group + g) * lanes + lane, channels_count - 1);
+            lane_data[g][lane] = source.getLane(channel_numbers[channel], start_sample);
+        }
+    }
+
+    // Samples are gathered into registers in short runs before they are filtered. Register loaded right after
+    // its lanes were written one by one waits for the stores, which would stall the filters on every sample.
+    // Squares of a run are summed in register precision and then added to double sums of the bin, so float sums never get long.
+    constexpr int run_length = 32;
+    alignas(alignof(SIMDType)) Sample input_lanes[run_length][GroupsCount][lanes];
+    alignas(alignof(SIMDType)) Sample run_square_sums[GroupsCount][lanes];
+    double* bin_square_sums = &filling_bin_square_sums[first_group * lanes];
+
+    // Local copies of the state, so compiler can keep them in registers
+    SIMDType shelf_z1[GroupsCount], shelf_z2[GroupsCount], pass_z1[GroupsCount], pass_z2[GroupsCount];
+    {
+        alignas(alignof(SIMDType)) Sample state_lanes[4][lanes];
+        for (int g = 0; g < GroupsCount; g++) {
+            const int first_lane = (first_group + g) * lanes;
+            for (int lane = 0; lane < lanes; lane++) {
+                state_lanes[0][lane] = static_cast<Sample>(high_shelf_z1[first_lane + lane]);
+                state_lanes[1][lane] = static_cast<Sample>(high_shelf_z2[first_lane + lane]);
+                state_lanes[2][lane] = static_cast<Sample>(high_pass_z1[first_lane + lane]);
+                state_lanes[3][lane] = static_cast<Sample>(high_pass_z2[first_lane + lane]);
+            }
+            shelf_z1[g] = SIMDType::fromRawArray(state_lanes[0]);
+            shelf_z2[g] = SIMDType::fromRawArray(state_lanes[1]);
+            pass_z1[g] = SIMDType::fromRawArray(state_lanes[2]);
+            pass_z2[g] = SIMDType::fromRawArray(state_lanes[3]);
+        }
+    }
+
+    for (int run_start = 0; run_start < samplesNum; run_start += run_length) {
+        const int run_samples = std::min(run_length, samplesNum - run_start);
+
+        for (int g = 0; g < GroupsCount; g++) {
+            for (int lane = 0; lane < lanes; lane++) {
+                for (int i = 0; i < run_samples; i++) {
+                    input_lanes[i][g][lane] = static_cast<Sample>(source.read(lane_data[g][lane], run_start + i));
+                }
+            }
+        }
+
+        SIMDType square_sum[GroupsCount];
+        for (int g = 0; g < GroupsCount; g++) {
+            square_sum[g] = SIMDType::expand(static_cast<Sample>(0));
+        }
+
+        if (!use_filters) {
+            for (int i = 0; i < run_samples; i++) {
+                for (int g = 0; g < GroupsCount; g++) {
+                    SIMDType input = SIMDType::fromRawArray(input_lanes[i][g]) * input_scale;
+                    square_sum[g] += input * input;
+                }
+            }
+        }
+        else {
+            for (int i = 0; i < run_samples; i++) {
+                for (int g = 0; g < GroupsCount; g++) {
+                    SIMDType input = SIMDType::fromRawArray(input_lanes[i][g]);
+
+                    SIMDType shelf_output = shelf_b0 * input + shelf_z1[g];
+                    shelf_z1[g] = shelf_b1 * input - shelf_a1 * shelf_output + shelf_z2[g];
+                    shelf_z2[g] = shelf_b2 * input - shelf_a2 * shelf_output;
+
+                    SIMDType pass_output = pass_b0 * shelf_output + pass_z1[g];
+                    pass_z1[g] = pass_b1 * shelf_output - pass_a1 * pass_output + pass_z2[g];
+                    pass_z2[g] = pass_b2 * shelf_output - pass_a2 * pass_output;
+
+                    square_sum[g] += pass_output * pass_output;
+                }
+            }
+        }
+
+        for (int g = 0; g < GroupsCount; g++) {
+            square_sum[g].copyToRawArray(run_square_sums[g]);
+            for (int lane = 0; lane < lanes; lane++) {
+                bin_square_sums[g * lanes + lane] += static_cast<double>(run_square_sums[g][lane]);
+            }
+        }
+    }
+
+    {
+        alignas(alignof(SIMDType)) Sample state_lanes[4][lanes];
+        for (int g = 0; g < GroupsCount; g++) {
+            shelf_z1[g].copyToRawArray(state_lanes[0]);
+            shelf_z2[g].copyToRawArray(state_lanes[1]);
+            pass_z1[g].copyToRawArray(state_lanes[2]);
+            pass_z2[g].copyToRawArray(state_lanes[3]);
+
+            const int first_lane = (first_group + g) * lanes;
+            for (int lane = 0; lane < lanes; lane++) {
+                high_shelf_z1[first_lane + lane] = state_lanes[0][lane];
+                high_shelf_z2[first_lane + lane] = state_lanes[1][lane];
+                high_pass_z1[first_lane + lane] = state_lanes[2][lane];
+                high_pass_z2[first_lane + lane] = state_lanes[3][lane];
+            }
+        }
+    }
+}
+
+void LufsChannelBank::completeSubBin()
+{
+    // Only what was added since the previous sub bin, O(channels) no matter how long the windows are
+    double* sub_bin = &sub_bin_square_sums[((completed_bins_count % (bins_in_3s + 1)) * sub_bins_per_bin + completed_sub_bins_in_filling_bin) * lanes_count];
+    for (int lane = 0; lane < lanes_count; lane++) {
+        sub_bin[lane] = filling_bin_square_sums[lane] - sub_bin_start_square_sums[lane];
+        sub_bin_start_square_sums[lane] = filling_bin_square_sums[lane];
+    }
+    completed_sub_bins_in_filling_bin++;
+}
+
+unsigned int LufsChannelBank::getSubBinEnd(unsigned int sub_bin) const
+{
+    return static_cast<unsigned int>((static_cast<unsigned long long int>(sub_bin) + 1) * bin_length_in_samples / sub_bins_per_bin);
+}
+
+unsigned int LufsChannelBank::getSamplesLeftInFillingBin() const
+{
+    return bin_length_in_samples - current_position_in_filling_bin;
+}
+
+unsigned int LufsChannelBank::getSamplesLeftInFillingSubBin() const
+{
+    return getSubBinEnd(completed_sub_bins_in_filling_bin) - current_position_in_filling_bin;
+}
+
+unsigned long long int LufsChannelBank::getCompletedBinsCount() const
+{
+    return completed_bins_count;
+}
+
+unsigned int LufsChannelBank::getCompletedSubBinsInFillingBin() const
+{
+    return completed_sub_bins_in_filling_bin;
+}
+
+unsigned int LufsChannelBank::getBinLengthInSamples() const
+{
+    return bin_length_in_samples;
+}
+
+double LufsChannelBank::calculateWeightedPower(unsigned long long int last_bin_index, unsigned int bins_count) const
+{
+    // Ring holds only the last bins_in_3s bins, older ones were already overwritten.
+    jassert(last_bin_index < completed_bins_count && completed_bins_count - last_bin_index + bins_count - 1 <= bins_in_3s);
+
+    // sum of weighted mean squares of bins_count bins ending with last_bin_index, for all channels
+    double power_sum = 0.0;
+    for (unsigned int i = 0; i < bins_count; i++) {
+        const double* bin = &bin_rms_container[((last_bin_index - i) % bins_in_3s) * lanes_count];
+        for (int lane = 0; lane < lanes_count; lane++) {
+            power_sum += bin[lane] * lane_weights[lane];
+        }
+    }
+
+    return power_sum / bins_count;
+}
+
+void LufsChannelBank::calculateChannelPowers(unsigned long long int last_bin_index, unsigned int bins_count, double* channel_powers) const
+{
+    jassert(last_bin_index < completed_bins_count && completed_bins_count - last_bin_index + bins_count - 1 <= bins_in_3s);
+
+    // Padding lanes of the last group are skipped
+    for (int channel = 0; channel < getMeasuredChannelsCount(); channel++) {
+        double power_sum = 0.0;
+        for (unsigned int i = 0; i < bins_count; i++) {
+            power_sum += bin_rms_container[((last_bin_index - i) % bins_in_3s) * lanes_count + channel];
+        }
+        channel_powers[channel_numbers[channel]] = power_sum / bins_count;
+    }
+}
+
+double LufsChannelBank::calculateWeightedSubBinSquareSum(unsigned long long int bin_index, unsigned int sub_bin) const
+{
+    // Ring holds sub bins of the bin being filled and of bins_in_3s bins before it
+    jassert(bin_index <= completed_bins_count && completed_bins_count - bin_index <= bins_in_3s && sub_bin < sub_bins_per_bin);
+
+    const double* sub_bin_sums = &sub_bin_square_sums[((bin_index % (bins_in_3s + 1)) * sub_bins_per_bin + sub_bin) * lanes_count];
+    double square_sum = 0.0;
+    for (int lane = 0; lane < lanes_count; lane++) {
+        square_sum += sub_bin_sums[lane] * lane_weights[lane];
+    }
+    return square_sum;
+}
+
+double LufsChannelBank::calculateWeightedFillingSquareSum() const
+{
+    // Square sum up to the end of the last completed sub bin
+    double square_sum = 0.0;
+    for (int lane = 0; lane < lanes_count; lane++) {
+        square_sum += sub_bin_start_square_sums[lane] * lane_weights[lane];
+    }
+    return square_sum;
+}
+
+int LufsChannelBank::getMeasuredChannelsCount() const
+{
+    return static_cast<int>(channel_numbers.size());
+}
+
+void LufsChannelBank::writeState(juce::OutputStream& stream) const
+{
+    const int channels_count = getMeasuredChannelsCount();
+
+    stream.writeInt(channels_count);
+    stream.writeInt(static_cast<int>(bin_length_in_samples));
+    stream.writeInt(static_cast<int>(bin_write_position));
+    stream.writeInt64(static_cast<juce::int64>(completed_bins_count));
+    stream.writeInt(static_cast<int>(current_position_in_filling_bin));
+    stream.writeInt(static_cast<int>(completed_sub_bins_in_filling_bin));
+
+    for (int channel = 0; channel < channels_count; channel++) {
+        stream.writeDouble(high_shelf_z1[channel]);
+        stream.writeDouble(high_shelf_z2[channel]);
+        stream.writeDouble(high_pass_z1[channel]);
+        stream.writeDouble(high_pass_z2[channel]);
+        stream.writeDouble(filling_bin_square_sums[channel]);
+        for (int bin = 0; bin < bins_in_3s; bin++) {
+            stream.writeDouble(bin_rms_container[bin * lanes_count + channel]);
+        }
+        stream.writeDouble(sub_bin_start_square_sums[channel]);
+        for (int sub_bin = 0; sub_bin < (bins_in_3s + 1) * sub_bins_per_bin; sub_bin++) {
+            stream.writeDouble(sub_bin_square_sums[sub_bin * lanes_count + channel]);
+        }
+    }
+}
+
+bool LufsChannelBank::readState(juce::InputStream& stream)
+{
+    const int channels_count = getMeasuredChannelsCount();
+
+    const int saved_channels_count = stream.readInt();
+    const unsigned int saved_bin_length = static_cast<unsigned int>(stream.readInt());
+    const unsigned int saved_bin_write_position = static_cast<unsigned int>(stream.readInt());
+    const unsigned long long int saved_completed_bins_count = static_cast<unsigned long long int>(stream.readInt64());
+    const unsigned int saved_position_in_filling_bin = static_cast<unsigned int>(stream.readInt());
+    const unsigned int saved_completed_sub_bins = static_cast<unsigned int>(stream.readInt());
+
+    if (saved_channels_count != channels_count || saved_bin_length != bin_length_in_samples
+        || saved_bin_write_position >= bins_in_3s || saved_position_in_filling_bin >= bin_length_in_samples
+        || saved_completed_sub_bins >= sub_bins_per_bin
+        || stream.getNumBytesRemaining() < static_cast<juce::int64>(getMaxStateSize()) - 28) {
+        return false;
+    }
+
+    // Padding lanes keep zeros - their weight is 0 anyway
+    clearCounters();
+
+    for (int channel = 0; channel < channels_count; channel++) {
+        high_shelf_z1[channel] = stream.readDouble();
+        high_shelf_z2[channel] = stream.readDouble();
+        high_pass_z1[channel] = stream.readDouble();
+        high_pass_z2[channel] = stream.readDouble();
+        filling_bin_square_sums[channel] = stream.readDouble();
+        for (int bin = 0; bin < bins_in_3s; bin++) {
+            bin_rms_container[bin * lanes_count + channel] = stream.readDouble();
+        }
+        sub_bin_start_square_sums[channel] = stream.readDouble();
+        for (int sub_bin = 0; sub_bin < (bins_in_3s + 1) * sub_bins_per_bin; sub_bin++) {
+            sub_bin_square_sums[sub_bin * lanes_count + channel] = stream.readDouble();
+        }
+    }
+
+    bin_write_position = saved_bin_write_position;
+    completed_bins_count = saved_completed_bins_count;
+    current_position_in_filling_bin = saved_position_in_filling_bin;
+    completed_sub_bins_in_filling_bin = saved_completed_sub_bins;
+    return true;
+}
+
+size_t LufsChannelBank::getMaxStateSize() const
+{
+    // counters, then filters, filling bin, bins, filling sub bin start and sub bins (all double) of every channel
+    return 28 + static_cast<size_t>(getMeasuredChannelsCount()) * (4 + 1 + bins_in_3s + 1 + (bins_in_3s + 1) * sub_bins_per_bin) * 8;
+}
+
+float LufsChannelBank::getChannelWeight(const juce::AudioChannelSet& channelSet, int channel_index)
+{
+    // BS.1770 doesn't define weights for ambisonics - only omnidirectional component (W, ACN 0) is measured
+    if (channelSet.getAmbisonicOrder() >= 0) {
+        return channel_index == 0 ? 1.0f : 0.0f;
+    }
+
+    return getChannelWeight(channelSet.getTypeOfChannel(channel_index));
+}
+
+float LufsChannelBank::getChannelWeight(juce::AudioChannelSet::ChannelType type)
+{
+    switch (type) {
+    case juce::AudioChannelSet::LFE:
+    case juce::AudioChannelSet::LFE2:
+        return 0.0f;
+
+    // BS.1770 table 4 - azimuth between 60 and 120 degrees, elevation below 30 degrees
+    case juce::AudioChannelSet::leftSurround:
+    case juce::AudioChannelSet::rightSurround:
+    case juce::AudioChannelSet::leftSurroundSide:
+    case juce::AudioChannelSet::rightSurroundSide:
+    case juce::AudioChannelSet::wideLeft:
+    case juce::AudioChannelSet::wideRight:
+        return 1.41f;
+
+    // Front, rear (above 120 degrees) and height channels
+    default:
+        return 1.0f;
+    }
+}
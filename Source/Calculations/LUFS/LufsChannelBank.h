@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    LufsChannelBank.h
+    Created: 7 Jan 2024 12:51:47pm
+    Author:  kubam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "KWeighting.h"
+
+// Interleaved little endian PCM, as stored in uncompressed WAV files.
+// Lets offline analysis feed memory mapped files to the channels without converting them to AudioBuffer first.
+struct InterleavedPcm {
+    enum class SampleFormat { int16, int24, float32 };
+
+    const void* data = nullptr; // First sample of the first frame, doesn't have to be aligned
+    int frame_channels = 0; // Number of channels in each frame (all of them, including not measured ones)
+    SampleFormat format = SampleFormat::float32;
+};
+
+// State of all measured channels, stored as structure of arrays.
+// Channels are packed into SIMD registers (groups of SIMDFloat::size() channels),
+// so K-weighting and squaring run for several channels at once.
+// Float samples are filtered in float registers, double samples in double registers (half as many lanes each).
+// Squares are summed in register precision only over short runs of samples, bins and sub bins are accumulated in double.
+class LufsChannelBank {
+public:
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+
+    LufsChannelBank();
+
+    // Builds channels from the layout. Channels with weight 0 (LFE) are not measured at all.
+    void prepareToPlay(double sampleRate, int samplesPerBlock, const juce::AudioChannelSet& channelSet, const KWeightingCoefficients& filter_coefficients);
+
+    // Same, with type of every channel in buffer order - for files, whose channels don't have to be in AudioChannelSet order
+    void prepareToPlay(double sampleRate, int samplesPerBlock, const juce::Array<juce::AudioChannelSet::ChannelType>& channelTypes, const KWeightingCoefficients& filter_coefficients);
+
+    void clearCounters();
+
+    // channel_data - read pointers of all channels of the host buffer (indexed like channelSet)
+    void fillBins(const float* const* channel_data, int start_sample, int samplesNum);
+
+    // Double precision host buffer - filtered in double with double coefficients, nothing is narrowed to float
+    void fillBins(const double* const* channel_data, int start_sample, int samplesNum);
+
+    // Same for interleaved PCM - conversion to float is folded into the first filter stage
+    void fillBins(const InterleavedPcm& pcm, int start_sample, int samplesNum);
+
+    unsigned int getSamplesLeftInFillingBin() const;
+    unsigned int getSamplesLeftInFillingSubBin() const;
+    unsigned long long int getCompletedBinsCount() const;
+    unsigned int getCompletedSubBinsInFillingBin() const;
+    unsigned int getBinLengthInSamples() const;
+
+    // Channel weighted mean square of bins_count bins ending with bin last_bin_index
+    double calculateWeightedPower(unsigned long long int last_bin_index, unsigned int bins_count) const;
+
+    // Mean square of every measured channel on its own (not weighted) over bins_count bins ending with bin last_bin_index.
+    // Written to channel_powers at host buffer channel indices, values of channels that are not measured are left as they are.
+    void calculateChannelPowers(unsigned long long int last_bin_index, unsigned int bins_count, double* channel_powers) const;
+
+    // Channel weighted sum of squares (not divided by length) of single sub bin of bin bin_index.
+    // Sub bins of the bin being filled and of the last bins_in_3s bins are available.
+    double calculateWeightedSubBinSquareSum(unsigned long long int bin_index, unsigned int sub_bin) const;
+
+    // Channel weighted sum of squares of all completed sub bins of the bin being filled
+    double calculateWeightedFillingSquareSum() const;
+
+    int getMeasuredChannelsCount() const;
+
+    // Filter states, partially filled bin and rings of the last bins and sub bins, written channel by channel
+    // (not register by register), so state doesn't depend on SIMD width of the machine.
+    // readState returns false if state was written for other channels or other bin length.
+    void writeState(juce::OutputStream& stream) const;
+    bool readState(juce::InputStream& stream);
+    size_t getMaxStateSize() const;
+
+    static float getChannelWeight(const juce::AudioChannelSet& channelSet, int channel_index);
+    static float getChannelWeight(juce::AudioChannelSet::ChannelType type);
+
+    static constexpr unsigned short int bins_in_400ms = 4; // Number of bins that form Momentary Loudness
+    static constexpr unsigned short int bins_in_3s = 30; // Number of bins that form Short Term Loudness
+    static constexpr unsigned short int sub_bins_per_bin = 10; // 10ms sub bins, for loudness updated more often than every bin
+
+private:
+    // channel_weights - weight of every channel of the buffer, 0 for channels that are not measured
+    void prepareChannels(double sampleRate, const std::vector<float>& channel_weights, const KWeightingCoefficients& filter_coefficients);
+
+    // SampleSource gives access to samples of one channel (see LufsChannelBank.cpp), so one kernel serves all input formats
+    template <typename SampleSource>
+    void fillBinsFrom(const SampleSource& source, int start_sample, int samplesNum);
+
+    // Filters in registers of the source's sample type
+    template <typename SampleSource>
+    void filterAndAccumulate(const SampleSource& source, int start_sample, int samplesNum);
+
+    // GroupsCount registers (of SIMDType::size() lanes each) starting with first_group, filtered together
+    template <typename SIMDType, int GroupsCount, typename SampleSource>
+    void filterAndAccumulateGroups(const SampleSource& source, int start_sample, int samplesNum, int first_group);
+
+    void completeSubBin();
+
+    // Position in bin where sub bin ends. Bin length doesn't have to be divisible by sub_bins_per_bin -
+    // sub bins differ by at most one sample, and sub_bins_per_bin of them are always exactly one bin.
+    unsigned int getSubBinEnd(unsigned int sub_bin) const;
+
+    // Per channel values - indexed by measured channel
+    std::vector<int> channel_numbers; // Index of measured channel in host buffer
+    std::vector<float> weights;
+
+    int groups_count; // One float SIMD register holds SIMDFloat::size() channels
+
+    // Per lane values - lanes_count (groups_count * SIMDFloat::size()) doubles, lane of a group after lane.
+    // Padding lanes of the last group read last channel again, their weight is 0.
+    // Filter states are kept in double for both kernels, float kernel rounds them only while it runs.
+    std::vector<double> high_shelf_z1;
+    std::vector<double> high_shelf_z2;
+    std::vector<double> high_pass_z1;
+    std::vector<double> high_pass_z2;
+    std::vector<double> lane_weights;
+    std::vector<double> filling_bin_square_sums; // Sum of squares of samples in the bin that is being filled
+    int lanes_count;
+
+    // bin: 100ms - length container
+    // Ring of the last bins_in_3s bins (mean square of samples in each bin), bin after bin, lanes_count values each.
+    std::vector<double> bin_rms_container;
+    unsigned int bin_write_position = 0; // Slot in bin_rms_container that the next completed bin goes to
+    unsigned long long int completed_bins_count = 0; // Number of bins filled since the start of measurement
+    unsigned int current_position_in_filling_bin = 0; // Position in bin for filling it.
+
+    // sub bin: 10ms - part of a bin. Sub bins only record what was added to filling_bin_square_sums,
+    // so bins themselves are accumulated exactly the same way as without them.
+    // Ring of sub bins of the last bins_in_3s bins and of the bin being filled, sub_bins_per_bin sub bins per bin.
+    std::vector<double> sub_bin_square_sums;
+    std::vector<double> sub_bin_start_square_sums; // filling_bin_square_sums at the start of the filling sub bin
+    unsigned int completed_sub_bins_in_filling_bin = 0;
+    unsigned int bin_length_in_samples; // length of single bin
+
+    KWeightingCoefficients filterCoefficients;
+    bool use_filters;
+};
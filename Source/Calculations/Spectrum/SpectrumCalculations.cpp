@@ -0,0 +1,285 @@
+/*
+  ==============================================================================
+
+    SpectrumCalculations.cpp
+
+  ==============================================================================
+*/
+
+// sources:
+//https://www.ni.com/docs/en-US/bundle/labview/page/spectral-analysis-windowing.html (power of windowed spectrum)
+//https://en.wikipedia.org/wiki/Spectral_flatness
+
+#include "SpectrumCalculations.h"
+
+SpectrumCalculations::SharedWorker::SharedWorker() :
+    juce::TimeSliceThread("Spectrum analysis")
+{
+    startThread();
+}
+
+SpectrumCalculations::SharedWorker::~SharedWorker()
+{
+    stopThread(1000);
+}
+
+SpectrumCalculations::SpectrumCalculations() :
+    worker(),
+    downmix(),
+    fifo(1),
+    queue(),
+    reset_generation(0),
+    dropped_samples_count(0),
+    fft(),
+    window(),
+    fft_size(0),
+    hop_size(0),
+    sample_rate(0.0),
+    window_power_sum(0.0),
+    frame(),
+    samples_in_frame(0),
+    fft_data(),
+    band_first_bins(),
+    band_end_bins(),
+    worker_generation(0),
+    worker_result(),
+    published_results_count(0),
+    results(),
+    worker_slot(0),
+    middle_slot(1),
+    reader_slot(2)
+{
+}
+
+SpectrumCalculations::~SpectrumCalculations()
+{
+    worker->removeTimeSliceClient(this);
+}
+
+void SpectrumCalculations::prepareToPlay(double sampleRate, int samplesPerBlock, int channelCount)
+{
+    juce::ignoreUnused(channelCount);
+
+    // Waits until the worker is done with this instance, if it is just in its slice
+    worker->removeTimeSliceClient(this);
+
+    // Shortest power of two FFT with bins no wider than max_bin_width_hz - 16384 at 48 kHz (341 ms frames)
+    int fft_order = 10;
+    while (sampleRate / (1 << fft_order) > max_bin_width_hz) {
+        fft_order++;
+    }
+    fft_size = 1 << fft_order;
+    hop_size = fft_size / 2;
+    sample_rate = sampleRate;
+
+    fft = std::make_unique<juce::dsp::FFT>(fft_order);
+    window = std::make_unique<juce::dsp::WindowingFunction<float>>(static_cast<size_t>(fft_size), juce::dsp::WindowingFunction<float>::hann, false);
+
+    // Window applied to ones gives the window itself
+    std::vector<float> window_values(static_cast<size_t>(fft_size), 1.0f);
+    window->multiplyWithWindowingTable(window_values.data(), static_cast<size_t>(fft_size));
+    window_power_sum = 0.0;
+    for (float value : window_values) {
+        window_power_sum += static_cast<double>(value) * value;
+    }
+
+    frame.assign(static_cast<size_t>(fft_size), 0.0f);
+    fft_data.assign(static_cast<size_t>(2 * fft_size), 0.0f);
+    samples_in_frame = 0;
+
+    // Bin belongs to the band its frequency is in, band edges are a sixth of octave from the centre
+    const double bin_width = sampleRate / fft_size;
+    band_first_bins.assign(SpectrumResult::bands_count, 0);
+    band_end_bins.assign(SpectrumResult::bands_count, 0);
+    for (int band = 0; band < SpectrumResult::bands_count; band++) {
+        const double centre = SpectrumResult::getBandCentreFrequency(band);
+        band_first_bins[band] = std::min(static_cast<int>(std::ceil(centre * std::pow(2.0, -1.0 / 6.0) / bin_width)), fft_size / 2);
+        band_end_bins[band] = std::min(static_cast<int>(std::ceil(centre * std::pow(2.0, 1.0 / 6.0) / bin_width)), fft_size / 2);
+    }
+
+    downmix.assign(static_cast<size_t>(std::max(samplesPerBlock, 1)), 0.0f);
+    queue.assign(static_cast<size_t>(queued_frames_count * fft_size), 0.0f);
+    fifo.setTotalSize(queued_frames_count * fft_size);
+    dropped_samples_count = 0;
+
+    worker_generation = reset_generation.load();
+    worker_result = SpectrumResult();
+    for (auto& stamped_result : results) {
+        stamped_result = StampedResult();
+    }
+    worker_slot = 0;
+    middle_slot.store(1);
+    reader_slot = 2;
+
+    worker->addTimeSliceClient(this);
+}
+
+void SpectrumCalculations::releaseResources()
+{
+    worker->removeTimeSliceClient(this);
+    fifo.reset();
+}
+
+void SpectrumCalculations::clearCounters()
+{
+    reset_generation.fetch_add(1, std::memory_order_release);
+    dropped_samples_count = 0;
+}
+
+void SpectrumCalculations::processBlock(const juce::AudioBuffer<float>& buffer, int channelCount)
+{
+    processBuffer(buffer, channelCount);
+}
+
+void SpectrumCalculations::processBlock(const juce::AudioBuffer<double>& buffer, int channelCount)
+{
+    processBuffer(buffer, channelCount);
+}
+
+template <typename SampleType>
+void SpectrumCalculations::processBuffer(const juce::AudioBuffer<SampleType>& buffer, int channelCount)
+{
+    const int samplesNum = buffer.getNumSamples();
+    channelCount = std::min(channelCount, buffer.getNumChannels());
+    if (channelCount <= 0 || downmix.empty()) {
+        return;
+    }
+
+    const float channel_gain = 1.0f / static_cast<float>(channelCount);
+    const int part_length = static_cast<int>(downmix.size());
+
+    // Host may send bigger block than announced in prepareToPlay - it is downmixed in parts
+    for (int start_sample = 0; start_sample < samplesNum; start_sample += part_length) {
+        const int length = std::min(part_length, samplesNum - start_sample);
+
+        std::fill(downmix.begin(), downmix.begin() + length, 0.0f);
+        for (int channel = 0; channel < channelCount; ++channel) {
+            const SampleType* channelData = buffer.getReadPointer(channel, start_sample);
+            for (int i = 0; i < length; i++) {
+                downmix[static_cast<size_t>(i)] += static_cast<float>(channelData[i]) * channel_gain;
+            }
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(length, start1, size1, start2, size2);
+        std::copy(downmix.begin(), downmix.begin() + size1, queue.begin() + start1);
+        std::copy(downmix.begin() + size1, downmix.begin() + size1 + size2, queue.begin() + start2);
+        fifo.finishedWrite(size1 + size2);
+
+        dropped_samples_count += static_cast<unsigned long long int>(length - size1 - size2);
+    }
+}
+
+bool SpectrumCalculations::getLatestResult(SpectrumResult& result)
+{
+    if ((middle_slot.load(std::memory_order_relaxed) & new_result_flag) == 0) {
+        return false;
+    }
+
+    reader_slot = middle_slot.exchange(reader_slot, std::memory_order_acq_rel) & ~new_result_flag;
+
+    // Frames analysed before the last clearCounters are not shown
+    const StampedResult& stamped_result = results[static_cast<size_t>(reader_slot)];
+    if (stamped_result.generation != reset_generation.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    result = stamped_result.result;
+    return true;
+}
+
+int SpectrumCalculations::getFftSize() const
+{
+    return fft_size;
+}
+
+unsigned long long int SpectrumCalculations::getDroppedSamplesCount() const
+{
+    return dropped_samples_count;
+}
+
+int SpectrumCalculations::useTimeSlice()
+{
+    // Everything queued before clearCounters is dropped. Consumer may move read position on its own.
+    const unsigned int generation = reset_generation.load(std::memory_order_acquire);
+    if (generation != worker_generation) {
+        worker_generation = generation;
+        fifo.finishedRead(fifo.getNumReady());
+        samples_in_frame = 0;
+        worker_result = SpectrumResult();
+    }
+
+    // Frames overlap by half - after the first one, every hop_size new samples give a new frame
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(fft_size - samples_in_frame, start1, size1, start2, size2);
+    std::copy(queue.begin() + start1, queue.begin() + start1 + size1, frame.begin() + samples_in_frame);
+    std::copy(queue.begin() + start2, queue.begin() + start2 + size2, frame.begin() + samples_in_frame + size1);
+    fifo.finishedRead(size1 + size2);
+    samples_in_frame += size1 + size2;
+
+    if (samples_in_frame < fft_size) {
+        return worker_poll_interval_ms;
+    }
+
+    analyseFrame();
+    publishResult();
+
+    std::copy(frame.begin() + hop_size, frame.end(), frame.begin());
+    samples_in_frame = fft_size - hop_size;
+
+    // Next frame may be queued already
+    return fifo.getNumReady() >= hop_size ? 0 : worker_poll_interval_ms;
+}
+
+void SpectrumCalculations::analyseFrame()
+{
+    std::copy(frame.begin(), frame.end(), fft_data.begin());
+    std::fill(fft_data.begin() + fft_size, fft_data.end(), 0.0f);
+    window->multiplyWithWindowingTable(fft_data.data(), static_cast<size_t>(fft_size));
+
+    // Magnitudes of bins 0 - fft_size / 2 end up at the start of fft_data
+    fft->performFrequencyOnlyForwardTransform(fft_data.data(), true);
+
+    // Parseval: sum of |X|^2 over all bins = fft_size * sum of (x * w)^2. Bins of negative frequencies mirror positive ones,
+    // so bin power * 2 / (fft_size * window_power_sum) is the bin's part of mean square of the signal.
+    const double power_scale = 2.0 / (fft_size * window_power_sum);
+    const double bin_width = sample_rate / fft_size;
+
+    for (int band = 0; band < SpectrumResult::bands_count; band++) {
+        double band_power = 0.0;
+        for (int bin = band_first_bins[band]; bin < band_end_bins[band]; bin++) {
+            band_power += static_cast<double>(fft_data[bin]) * fft_data[bin];
+        }
+        worker_result.band_rms[band] = std::sqrt(band_power * power_scale);
+    }
+
+    // DC is left out of both - it is not a frequency of the signal
+    double magnitude_sum = 0.0;
+    double weighted_frequency_sum = 0.0;
+    double power_sum = 0.0;
+    double log_power_sum = 0.0;
+    const int bins_count = fft_size / 2;
+    for (int bin = 1; bin <= bins_count; bin++) {
+        const double magnitude = fft_data[bin];
+        const double power = magnitude * magnitude + std::numeric_limits<float>::min(); // log of silent bin stays finite
+        magnitude_sum += magnitude;
+        weighted_frequency_sum += magnitude * bin * bin_width;
+        power_sum += power;
+        log_power_sum += std::log(power);
+    }
+
+    const bool silent = magnitude_sum <= 0.0;
+    worker_result.centroid = silent ? 0.0 : weighted_frequency_sum / magnitude_sum;
+    worker_result.flatness = silent ? 0.0 : std::exp(log_power_sum / bins_count) / (power_sum / bins_count);
+    worker_result.frames_count++;
+}
+
+void SpectrumCalculations::publishResult()
+{
+    StampedResult& stamped_result = results[static_cast<size_t>(worker_slot)];
+    stamped_result.result = worker_result;
+    stamped_result.result.sequence_number = ++published_results_count;
+    stamped_result.generation = worker_generation;
+
+    worker_slot = middle_slot.exchange(worker_slot | new_result_flag, std::memory_order_acq_rel) & ~new_result_flag;
+}
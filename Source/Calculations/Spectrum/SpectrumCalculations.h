@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    SpectrumCalculations.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpectrumResult.h"
+
+// Spectrum of the mono downmix of all channels: Hann windowed FFT frames overlapping by half, split into third octave bands.
+// Audio thread only downmixes blocks into a wait-free queue - FFTs run on a background thread, which polls the queue.
+// One thread is shared by all instances in the process, every prepared instance gets time slices on it.
+// Results go back through a triple buffer, so neither side ever waits for the other.
+class SpectrumCalculations : private juce::TimeSliceClient {
+public:
+    SpectrumCalculations();
+    ~SpectrumCalculations() override;
+
+    // Allocates FFT, window and queue for the sample rate and attaches to the shared worker. Not on the audio thread.
+    void prepareToPlay(double sampleRate, int samplesPerBlock, int channelCount);
+
+    // Detaches from the shared worker, queued samples are dropped
+    void releaseResources();
+
+    // Audio thread - the worker drops everything queued so far and starts from scratch, dropped samples count is reset
+    void clearCounters();
+
+    // Audio thread. Cost is a downmix and a copy, linear in block length - no FFT, no locks, no allocations.
+    // If the worker can't keep up (queue holds 4 FFT frames), samples that don't fit are dropped.
+    void processBlock(const juce::AudioBuffer<float>& buffer, int channelCount);
+    void processBlock(const juce::AudioBuffer<double>& buffer, int channelCount);
+
+    // Audio thread. Copies result of the newest frame to result and returns true, if a frame was analysed since the last call.
+    bool getLatestResult(SpectrumResult& result);
+
+    int getFftSize() const;
+
+    // Samples dropped because the queue was full, since prepareToPlay or clearCounters - audio thread only
+    unsigned long long int getDroppedSamplesCount() const;
+
+    // FFT is long enough for bins of at most this width, so that even the lowest third octave bands get some bins
+    static constexpr double max_bin_width_hz = 3.0;
+
+private:
+    template <typename SampleType>
+    void processBuffer(const juce::AudioBuffer<SampleType>& buffer, int channelCount);
+
+    // Worker thread - analyses at most one frame per slice, so that other instances get their turn
+    int useTimeSlice() override;
+    void analyseFrame();
+    void publishResult();
+
+    // Starts with the first instance and stops with the last one
+    struct SharedWorker : public juce::TimeSliceThread {
+        SharedWorker();
+        ~SharedWorker() override;
+    };
+
+    static constexpr int worker_poll_interval_ms = 10;
+    static constexpr int queued_frames_count = 4;
+
+    juce::SharedResourcePointer<SharedWorker> worker;
+
+    // Audio thread side
+    std::vector<float> downmix; // Scratch buffer of samplesPerBlock samples
+    juce::AbstractFifo fifo;
+    std::vector<float> queue;
+    std::atomic<unsigned int> reset_generation; // Increased by clearCounters
+    unsigned long long int dropped_samples_count;
+
+    // Worker side, allocated in prepareToPlay while not attached to the worker
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    int fft_size;
+    int hop_size;
+    double sample_rate;
+    double window_power_sum; // Sum of squared window values, to scale spectrum back to sample values
+    std::vector<float> frame; // Last fft_size samples
+    int samples_in_frame;
+    std::vector<float> fft_data; // 2 * fft_size, as performFrequencyOnlyForwardTransform needs
+    std::vector<int> band_first_bins;
+    std::vector<int> band_end_bins;
+    unsigned int worker_generation;
+    SpectrumResult worker_result;
+    unsigned long long int published_results_count; // Survives resets, so that readers tell every new result from the last one
+
+    // Triple buffer: worker fills its slot and swaps it with the middle one, audio thread swaps its slot with the middle one
+    // when the middle one is new. Slots are indices into results, new_result_flag is set on the middle index by the worker.
+    struct StampedResult {
+        SpectrumResult result;
+        unsigned int generation = 0;
+    };
+    static constexpr int new_result_flag = 4;
+    std::array<StampedResult, 3> results;
+    int worker_slot;
+    std::atomic<int> middle_slot;
+    int reader_slot;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumCalculations)
+};
@@ -0,0 +1,28 @@
+/*
+  ==============================================================================
+
+    SpectrumResult.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Spectral statistics of the last analysed FFT frame. Plain values only, so it can be a part of TelemetrySnapshot.
+struct SpectrumResult {
+    static constexpr int bands_count = 31; // Third octave bands, centre frequencies 20 Hz - 20 kHz (octave band = 3 neighbouring bands)
+
+    std::array<double, bands_count> band_rms {}; // In sample values, like time domain RMS - sine of amplitude 1 gives 0.707 in its band
+    double centroid = 0.0; // Hz, magnitude weighted mean frequency
+    double flatness = 0.0; // Geometric / arithmetic mean of power spectrum: 0 - pure tones, 1 - white noise
+    unsigned long long int frames_count = 0; // Frames analysed since the last reset
+    unsigned long long int sequence_number = 0; // Increased with every published result and never reset, 0 - nothing published
+
+    // Nominal centre frequency of band - 1 kHz * 2^(k/3), 1 kHz is band 17
+    static double getBandCentreFrequency(int band)
+    {
+        return 1000.0 * std::pow(2.0, (band - 17) / 3.0);
+    }
+};
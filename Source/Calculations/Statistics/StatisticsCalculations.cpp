@@ -0,0 +1,403 @@
+/*
+  ==============================================================================
+
+    StatisticsCalculations.cpp
+
+  ==============================================================================
+*/
+
+#include "StatisticsCalculations.h"
+
+StatisticsCalculations::StatisticsCalculations() :
+    first_samples(),
+    previous_samples(),
+    samples_count_per_channel(),
+    square_sum_per_channel(),
+    sum_per_channel(),
+    zero_passes_per_channel(),
+    min_per_channel(),
+    max_per_channel(),
+    has_previous_samples(false),
+    sample_rate(0.0),
+    zero_passes_count(0),
+    min_value(std::numeric_limits<double>::infinity()),
+    max_value(-std::numeric_limits<double>::infinity())
+{
+}
+
+void StatisticsCalculations::prepareToPlay(double sampleRate, int samplesPerBlock, int channelCount)
+{
+    juce::ignoreUnused(samplesPerBlock);
+    sample_rate = sampleRate;
+
+    if (static_cast<int>(previous_samples.size()) != channelCount) {
+        first_samples.assign(channelCount, 0.0);
+        previous_samples.assign(channelCount, 0.0);
+        samples_count_per_channel.assign(channelCount, 0);
+        square_sum_per_channel.assign(channelCount, 0.0);
+        sum_per_channel.assign(channelCount, 0.0);
+        zero_passes_per_channel.assign(channelCount, 0);
+        min_per_channel.assign(channelCount, std::numeric_limits<double>::infinity());
+        max_per_channel.assign(channelCount, -std::numeric_limits<double>::infinity());
+        has_previous_samples = false;
+    }
+}
+
+void StatisticsCalculations::clearCounters()
+{
+    zero_passes_count = 0;
+    min_value = std::numeric_limits<double>::infinity();
+    max_value = -std::numeric_limits<double>::infinity();
+
+    zero_passes->store(0);
+    rms->store(-std::numeric_limits<double>::infinity());
+
+    min->store(std::numeric_limits<double>::infinity());
+    max->store(-std::numeric_limits<double>::infinity());
+
+    std::fill(samples_count_per_channel.begin(), samples_count_per_channel.end(), 0);
+    std::fill(square_sum_per_channel.begin(), square_sum_per_channel.end(), 0.0);
+    std::fill(sum_per_channel.begin(), sum_per_channel.end(), 0.0);
+    std::fill(zero_passes_per_channel.begin(), zero_passes_per_channel.end(), 0);
+    std::fill(min_per_channel.begin(), min_per_channel.end(), std::numeric_limits<double>::infinity());
+    std::fill(max_per_channel.begin(), max_per_channel.end(), -std::numeric_limits<double>::infinity());
+    has_previous_samples = false;
+}
+
+void StatisticsCalculations::processBlock(const juce::AudioBuffer<float>& buffer, int channelCount)
+{
+    processSamples(buffer, channelCount);
+}
+
+void StatisticsCalculations::processBlock(const juce::AudioBuffer<double>& buffer, int channelCount)
+{
+    processSamples(buffer, channelCount);
+}
+
+template <typename SampleType>
+void StatisticsCalculations::processSamples(const juce::AudioBuffer<SampleType>& buffer, int channelCount)
+{
+    int samplesNum = buffer.getNumSamples();
+
+    jassert(channelCount <= static_cast<int>(previous_samples.size())); // prepareToPlay was called with other channel count
+    channelCount = std::min(channelCount, static_cast<int>(previous_samples.size()));
+
+    if (samplesNum == 0 || channelCount == 0) {
+        return;
+    }
+
+    if (!has_previous_samples) {
+        // There is no sample before the very first one, so it can't be a zero pass
+        for (int channel = 0; channel < channelCount; ++channel) {
+            first_samples[channel] = buffer.getReadPointer(channel)[0];
+            previous_samples[channel] = first_samples[channel];
+        }
+        has_previous_samples = true;
+    }
+
+    unsigned long long int block_zero_passes = 0;
+    double block_min = min_value;
+    double block_max = max_value;
+
+    for (int channel = 0; channel < channelCount; ++channel)
+    {
+        const SampleType* channelData = buffer.getReadPointer(channel);
+
+        const unsigned int channel_zero_passes = countZeroPasses(previous_samples[channel], channelData, samplesNum);
+        zero_passes_per_channel[channel] += channel_zero_passes;
+        block_zero_passes += channel_zero_passes;
+        previous_samples[channel] = channelData[samplesNum - 1];
+
+        // RMS, DC offset and min/max of the channel, all in a single pass over its samples
+        const BlockSums sums = calculateBlockSums(channelData, samplesNum);
+        samples_count_per_channel[channel] += samplesNum;
+        square_sum_per_channel[channel] += sums.square_sum;
+        sum_per_channel[channel] += sums.sum;
+        min_per_channel[channel] = std::min(min_per_channel[channel], sums.min);
+        max_per_channel[channel] = std::max(max_per_channel[channel], sums.max);
+
+        block_min = std::min(block_min, sums.min);
+        block_max = std::max(block_max, sums.max);
+    }
+
+    // Publish once per block
+    zero_passes_count += block_zero_passes;
+    zero_passes->store(static_cast<float>(zero_passes_count));
+
+    publishRms(channelCount);
+
+    if (block_min < min_value) {
+        min_value = block_min;
+        min->store(static_cast<float>(min_value));
+    }
+    if (block_max > max_value) {
+        max_value = block_max;
+        max->store(static_cast<float>(max_value));
+    }
+}
+
+unsigned long long int StatisticsCalculations::getZeroPassesCount() const
+{
+    return zero_passes_count;
+}
+
+int StatisticsCalculations::getChannelsCount() const
+{
+    return static_cast<int>(samples_count_per_channel.size());
+}
+
+double StatisticsCalculations::getRms() const
+{
+    const int channelCount = getChannelsCount();
+    if (channelCount == 0) {
+        return 0.0;
+    }
+
+    double rms_sum = 0.0;
+    for (int channel = 0; channel < channelCount; ++channel) {
+        rms_sum += getChannelRms(channel);
+    }
+    return rms_sum / channelCount;
+}
+
+double StatisticsCalculations::getChannelRms(int channel) const
+{
+    if (samples_count_per_channel[channel] == 0) {
+        return 0.0;
+    }
+    return std::sqrt(square_sum_per_channel[channel] / static_cast<double>(samples_count_per_channel[channel]));
+}
+
+double StatisticsCalculations::getChannelPeak(int channel) const
+{
+    if (samples_count_per_channel[channel] == 0) {
+        return 0.0;
+    }
+    return std::max(-min_per_channel[channel], max_per_channel[channel]);
+}
+
+double StatisticsCalculations::getChannelDcOffset(int channel) const
+{
+    if (samples_count_per_channel[channel] == 0) {
+        return 0.0;
+    }
+    return sum_per_channel[channel] / static_cast<double>(samples_count_per_channel[channel]);
+}
+
+double StatisticsCalculations::getChannelCrossingRate(int channel) const
+{
+    if (samples_count_per_channel[channel] == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(zero_passes_per_channel[channel]) * sample_rate / static_cast<double>(samples_count_per_channel[channel]);
+}
+
+double StatisticsCalculations::getMin() const
+{
+    return min_value;
+}
+
+double StatisticsCalculations::getMax() const
+{
+    return max_value;
+}
+
+void StatisticsCalculations::writeState(juce::OutputStream& stream) const
+{
+    const int channelCount = getChannelsCount();
+
+    stream.writeInt(channelCount);
+    for (int channel = 0; channel < channelCount; ++channel) {
+        stream.writeDouble(first_samples[channel]);
+        stream.writeDouble(previous_samples[channel]);
+        stream.writeInt64(static_cast<juce::int64>(samples_count_per_channel[channel]));
+        stream.writeDouble(square_sum_per_channel[channel]);
+        stream.writeDouble(sum_per_channel[channel]);
+        stream.writeInt64(static_cast<juce::int64>(zero_passes_per_channel[channel]));
+        stream.writeDouble(min_per_channel[channel]);
+        stream.writeDouble(max_per_channel[channel]);
+    }
+    stream.writeBool(has_previous_samples);
+    stream.writeInt64(static_cast<juce::int64>(zero_passes_count));
+    stream.writeDouble(min_value);
+    stream.writeDouble(max_value);
+}
+
+bool StatisticsCalculations::readState(juce::InputStream& stream)
+{
+    clearCounters();
+
+    const int channelCount = getChannelsCount();
+    if (stream.readInt() != channelCount || stream.getNumBytesRemaining() < static_cast<juce::int64>(getMaxStateSize()) - 4) {
+        return false;
+    }
+
+    for (int channel = 0; channel < channelCount; ++channel) {
+        first_samples[channel] = stream.readDouble();
+        previous_samples[channel] = stream.readDouble();
+        samples_count_per_channel[channel] = static_cast<unsigned long long int>(stream.readInt64());
+        square_sum_per_channel[channel] = stream.readDouble();
+        sum_per_channel[channel] = stream.readDouble();
+        zero_passes_per_channel[channel] = static_cast<unsigned long long int>(stream.readInt64());
+        min_per_channel[channel] = stream.readDouble();
+        max_per_channel[channel] = stream.readDouble();
+    }
+    has_previous_samples = stream.readBool();
+    zero_passes_count = static_cast<unsigned long long int>(stream.readInt64());
+    min_value = stream.readDouble();
+    max_value = stream.readDouble();
+
+    zero_passes->store(static_cast<float>(zero_passes_count));
+    if (has_previous_samples) {
+        publishRms(channelCount);
+    }
+    min->store(static_cast<float>(min_value));
+    max->store(static_cast<float>(max_value));
+    return true;
+}
+
+size_t StatisticsCalculations::getMaxStateSize() const
+{
+    return 4 + static_cast<size_t>(getChannelsCount()) * 64 + 1 + 8 + 8 + 8;
+}
+
+StatisticsPartialResult StatisticsCalculations::getPartialResult() const
+{
+    StatisticsPartialResult partialResult;
+    partialResult.first_samples = first_samples;
+    partialResult.last_samples = previous_samples;
+    partialResult.samples_count_per_channel = samples_count_per_channel;
+    partialResult.square_sum_per_channel = square_sum_per_channel;
+    partialResult.sum_per_channel = sum_per_channel;
+    partialResult.zero_passes_per_channel = zero_passes_per_channel;
+    partialResult.min_per_channel = min_per_channel;
+    partialResult.max_per_channel = max_per_channel;
+    partialResult.zero_passes_count = zero_passes_count;
+    partialResult.min_value = min_value;
+    partialResult.max_value = max_value;
+    return partialResult;
+}
+
+void StatisticsCalculations::mergePartialResult(const StatisticsPartialResult& partialResult)
+{
+    const int channelCount = static_cast<int>(previous_samples.size());
+    jassert(static_cast<int>(partialResult.last_samples.size()) == channelCount); // prepareToPlay was called with other channel count
+
+    bool chunk_has_samples = !partialResult.samples_count_per_channel.empty() && partialResult.samples_count_per_channel[0] > 0;
+    if (static_cast<int>(partialResult.last_samples.size()) != channelCount || !chunk_has_samples) {
+        return;
+    }
+
+    unsigned long long int merged_zero_passes = partialResult.zero_passes_count;
+    for (int channel = 0; channel < channelCount; ++channel) {
+        zero_passes_per_channel[channel] += partialResult.zero_passes_per_channel[channel];
+        if (has_previous_samples) {
+            // sign change between last sample of previous chunk and first sample of this one
+            const bool boundary_zero_pass = (previous_samples[channel] * partialResult.first_samples[channel]) < 0.0;
+            merged_zero_passes += boundary_zero_pass;
+            zero_passes_per_channel[channel] += boundary_zero_pass;
+        }
+        else {
+            first_samples[channel] = partialResult.first_samples[channel];
+        }
+        previous_samples[channel] = partialResult.last_samples[channel];
+        samples_count_per_channel[channel] += partialResult.samples_count_per_channel[channel];
+        square_sum_per_channel[channel] += partialResult.square_sum_per_channel[channel];
+        sum_per_channel[channel] += partialResult.sum_per_channel[channel];
+        min_per_channel[channel] = std::min(min_per_channel[channel], partialResult.min_per_channel[channel]);
+        max_per_channel[channel] = std::max(max_per_channel[channel], partialResult.max_per_channel[channel]);
+    }
+    has_previous_samples = true;
+
+    zero_passes_count += merged_zero_passes;
+    zero_passes->store(static_cast<float>(zero_passes_count));
+
+    publishRms(channelCount);
+
+    if (partialResult.min_value < min_value) {
+        min_value = partialResult.min_value;
+        min->store(static_cast<float>(min_value));
+    }
+    if (partialResult.max_value > max_value) {
+        max_value = partialResult.max_value;
+        max->store(static_cast<float>(max_value));
+    }
+}
+
+void StatisticsCalculations::publishRms(int channelCount)
+{
+    // mean of channel RMS values
+    double temp_rms = 0;
+    for (int channel = 0; channel < channelCount; ++channel) {
+        temp_rms = temp_rms + std::sqrt(square_sum_per_channel[channel] / samples_count_per_channel[channel]);
+    }
+    rms->store(static_cast<float>(temp_rms / channelCount));
+}
+
+template <typename SampleType>
+unsigned int StatisticsCalculations::countZeroPasses(double previous_sample, const SampleType* samples, int samplesNum)
+{
+    // Sign change between neighbouring samples. No branches and no loop carried dependency
+    // except for the integer counter, so compiler vectorizes it.
+    unsigned int zero_passes_in_block = (previous_sample * samples[0]) < 0.0;
+    for (int i = 1; i < samplesNum; i++) {
+        zero_passes_in_block += (samples[i - 1] * samples[i]) < SampleType(0);
+    }
+    return zero_passes_in_block;
+}
+
+template <typename SampleType>
+StatisticsCalculations::BlockSums StatisticsCalculations::calculateBlockSums(const SampleType* samples, int samplesNum)
+{
+    using SIMDSample = juce::dsp::SIMDRegister<SampleType>;
+    const int lanes = static_cast<int>(SIMDSample::size());
+
+    // Host buffers don't have to be SIMD aligned - unaligned head and tail are summed one by one.
+    // Single block is summed in the sample type (short sum, vectorized), blocks are added up in double by the caller.
+    const SampleType* aligned_start = SIMDSample::getNextSIMDAlignedPtr(const_cast<SampleType*>(samples));
+    int head_length = std::min(samplesNum, static_cast<int>(aligned_start - samples));
+    int simd_length = ((samplesNum - head_length) / lanes) * lanes;
+
+    SampleType sum = 0;
+    SampleType square_sum = 0;
+    SampleType min = std::numeric_limits<SampleType>::infinity();
+    SampleType max = -std::numeric_limits<SampleType>::infinity();
+    for (int i = 0; i < head_length; i++) {
+        sum += samples[i];
+        square_sum += samples[i] * samples[i];
+        min = std::min(min, samples[i]);
+        max = std::max(max, samples[i]);
+    }
+
+    SIMDSample simd_sum = SIMDSample::expand(0);
+    SIMDSample simd_square_sum = SIMDSample::expand(0);
+    SIMDSample simd_min = SIMDSample::expand(min);
+    SIMDSample simd_max = SIMDSample::expand(max);
+    for (int i = head_length; i < head_length + simd_length; i += lanes) {
+        SIMDSample values = SIMDSample::fromRawArray(samples + i);
+        simd_sum = simd_sum + values;
+        simd_square_sum = simd_square_sum + values * values;
+        simd_min = SIMDSample::min(simd_min, values);
+        simd_max = SIMDSample::max(simd_max, values);
+    }
+    sum += simd_sum.sum();
+    square_sum += simd_square_sum.sum();
+    for (size_t lane = 0; lane < SIMDSample::size(); lane++) {
+        min = std::min(min, simd_min.get(lane));
+        max = std::max(max, simd_max.get(lane));
+    }
+
+    for (int i = head_length + simd_length; i < samplesNum; i++) {
+        sum += samples[i];
+        square_sum += samples[i] * samples[i];
+        min = std::min(min, samples[i]);
+        max = std::max(max, samples[i]);
+    }
+
+    BlockSums sums;
+    sums.sum = static_cast<double>(sum);
+    sums.square_sum = static_cast<double>(square_sum);
+    sums.min = static_cast<double>(min);
+    sums.max = static_cast<double>(max);
+    return sums;
+}
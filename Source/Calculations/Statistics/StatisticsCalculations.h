@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    StatisticsCalculations.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Accumulators of one chunk of a file, joined in time order by StatisticsCalculations::mergePartialResult
+struct StatisticsPartialResult {
+    std::vector<double> first_samples; // needed to count zero passes on chunk boundaries
+    std::vector<double> last_samples;
+    std::vector<unsigned long long int> samples_count_per_channel;
+    std::vector<double> square_sum_per_channel;
+    std::vector<double> sum_per_channel;
+    std::vector<unsigned long long int> zero_passes_per_channel;
+    std::vector<double> min_per_channel;
+    std::vector<double> max_per_channel;
+    unsigned long long int zero_passes_count = 0;
+    double min_value = std::numeric_limits<double>::infinity();
+    double max_value = -std::numeric_limits<double>::infinity();
+};
+
+class StatisticsCalculations {
+public:
+    StatisticsCalculations();
+
+    void prepareToPlay(double sampleRate, int samplesPerBlock, int channelCount);
+
+    void clearCounters();
+
+    // Float and double blocks are measured natively, without conversion
+    void processBlock(const juce::AudioBuffer<float>& buffer, int channelCount);
+    void processBlock(const juce::AudioBuffer<double>& buffer, int channelCount);
+
+    // Exact number of zero passes - zero_passes parameter is a float, and stops counting at 2^24.
+    unsigned long long int getZeroPassesCount() const;
+
+    // Values since last clearCounters in full precision, for the telemetry snapshot - audio thread only
+    int getChannelsCount() const;
+    double getRms() const; // mean of channel RMS values
+    double getChannelRms(int channel) const;
+    double getMin() const;
+    double getMax() const;
+
+    // Per channel values (0 before the first sample): sample peak, DC offset (mean of samples)
+    // and zero crossing rate (zero passes per second)
+    double getChannelPeak(int channel) const;
+    double getChannelDcOffset(int channel) const;
+    double getChannelCrossingRate(int channel) const;
+
+    // Saved state of all accumulators. Neither allocates, readState returns false and clears counters
+    // if state was written for other channel count.
+    void writeState(juce::OutputStream& stream) const;
+    bool readState(juce::InputStream& stream);
+    size_t getMaxStateSize() const;
+
+    // Chunked measurement of one file - not meant for audio thread (they copy per channel vectors).
+    // Partial results have to be merged in the same order as chunks are in the file.
+    StatisticsPartialResult getPartialResult() const;
+    void mergePartialResult(const StatisticsPartialResult& partialResult);
+
+    std::atomic<float>* zero_passes = nullptr;
+    std::atomic<float>* rms = nullptr;
+    std::atomic<float>* min = nullptr;
+    std::atomic<float>* max = nullptr;
+
+private:
+    template <typename SampleType>
+    void processSamples(const juce::AudioBuffer<SampleType>& buffer, int channelCount);
+
+    template <typename SampleType>
+    static unsigned int countZeroPasses(double previous_sample, const SampleType* samples, int samplesNum);
+
+    // Everything measured from samples of one channel of one block
+    struct BlockSums {
+        double sum = 0.0;
+        double square_sum = 0.0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+    };
+
+    template <typename SampleType>
+    static BlockSums calculateBlockSums(const SampleType* samples, int samplesNum);
+
+    void publishRms(int channelCount);
+
+    // Per channel accumulators, allocated in prepareToPlay. Sums are kept in double - float sum stops growing
+    // once it is 2^24 times bigger than a block, which happens after minutes of measurement.
+    std::vector<double> first_samples;
+    std::vector<double> previous_samples;
+    std::vector<unsigned long long int> samples_count_per_channel;
+    std::vector<double> square_sum_per_channel;
+    std::vector<double> sum_per_channel;
+    std::vector<unsigned long long int> zero_passes_per_channel;
+    std::vector<double> min_per_channel;
+    std::vector<double> max_per_channel;
+    bool has_previous_samples;
+    double sample_rate;
+
+    // Values are reduced over the whole block in these, and published to parameters once per block
+    unsigned long long int zero_passes_count;
+    double min_value;
+    double max_value;
+};
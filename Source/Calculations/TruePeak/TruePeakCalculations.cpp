@@ -0,0 +1,206 @@
+/*
+  ==============================================================================
+
+    TruePeakCalculations.cpp
+
+  ==============================================================================
+*/
+
+// sources:
+//https://www.itu.int/dms_pubrec/itu-r/rec/bs/R-REC-BS.1770-5-202311-I!!PDF-E.pdf (Annex 2)
+
+#include "TruePeakCalculations.h"
+
+// 48-tap interpolating FIR from BS.1770 Annex 2, split into 4 phases of 12 taps
+const float TruePeakCalculations::coefficients[phases_count][taps_per_phase] = {
+    {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f, -0.0594482421875f,  0.1373291015625f,
+       0.9721679687500f, -0.1022949218750f,  0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+    { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f, -0.1665039062500f,  0.4650878906250f,
+       0.7797851562500f, -0.2003173828125f,  0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f },
+    { -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f, -0.2003173828125f,  0.7797851562500f,
+       0.4650878906250f, -0.1665039062500f,  0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f },
+    { -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f, -0.1022949218750f,  0.9721679687500f,
+       0.1373291015625f, -0.0594482421875f,  0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f }
+};
+
+TruePeakCalculations::TruePeakCalculations() :
+    phase_step(1),
+    part_length(0),
+    history(),
+    history_stride(0),
+    interpolated(),
+    channels_count(0),
+    channel_peaks(),
+    overall_peak(0.0f)
+{
+    for (auto& channel_true_peak : channel_true_peaks) {
+        channel_true_peak.store(-std::numeric_limits<float>::infinity());
+    }
+}
+
+void TruePeakCalculations::prepareToPlay(double sampleRate, int samplesPerBlock, int channelCount)
+{
+    phase_step = sampleRate >= 96000.0 ? 2 : 1;
+    part_length = std::max(samplesPerBlock, 1);
+
+    channels_count = channelCount;
+    history_stride = taps_per_phase - 1 + part_length;
+    history.assign(channels_count * history_stride, 0.0f);
+    interpolated.assign(part_length, 0.0f);
+    channel_peaks.assign(channels_count, 0.0f);
+}
+
+void TruePeakCalculations::clearCounters()
+{
+    std::fill(channel_peaks.begin(), channel_peaks.end(), 0.0f);
+    overall_peak = 0.0f;
+
+    true_peak->store(-std::numeric_limits<float>::infinity());
+    for (auto& channel_true_peak : channel_true_peaks) {
+        channel_true_peak.store(-std::numeric_limits<float>::infinity());
+    }
+}
+
+void TruePeakCalculations::processBlock(const juce::AudioBuffer<float>& buffer, int channelCount)
+{
+    processBuffer(buffer, channelCount);
+}
+
+void TruePeakCalculations::processBlock(const juce::AudioBuffer<double>& buffer, int channelCount)
+{
+    processBuffer(buffer, channelCount);
+}
+
+template <typename SampleType>
+void TruePeakCalculations::processBuffer(const juce::AudioBuffer<SampleType>& buffer, int channelCount)
+{
+    int samplesNum = buffer.getNumSamples();
+
+    jassert(channelCount <= channels_count); // prepareToPlay was called with other channel count
+    channelCount = std::min(channelCount, channels_count);
+
+    for (int channel = 0; channel < channelCount; ++channel) {
+        const SampleType* channelData = buffer.getReadPointer(channel);
+
+        // Host may send bigger block than announced in prepareToPlay - it is interpolated in parts
+        for (int start_sample = 0; start_sample < samplesNum; start_sample += part_length) {
+            float part_peak = processChannel(channel, channelData + start_sample, std::min(part_length, samplesNum - start_sample));
+            channel_peaks[channel] = std::max(channel_peaks[channel], part_peak);
+        }
+
+        overall_peak = std::max(overall_peak, channel_peaks[channel]);
+
+        if (channel < max_published_channels) {
+            channel_true_peaks[channel].store(gainToDecibels(channel_peaks[channel]));
+        }
+    }
+
+    // Publish once per block
+    true_peak->store(gainToDecibels(overall_peak));
+}
+
+void TruePeakCalculations::writeState(juce::OutputStream& stream) const
+{
+    stream.writeInt(channels_count);
+    stream.writeInt(phase_step);
+
+    for (int channel = 0; channel < channels_count; ++channel) {
+        const float* channel_history = history.data() + channel * history_stride;
+        for (int i = 0; i < taps_per_phase - 1; i++) {
+            stream.writeFloat(channel_history[i]);
+        }
+        stream.writeFloat(channel_peaks[channel]);
+    }
+    stream.writeFloat(overall_peak);
+}
+
+bool TruePeakCalculations::readState(juce::InputStream& stream)
+{
+    clearCounters();
+
+    if (stream.readInt() != channels_count || stream.readInt() != phase_step
+        || stream.getNumBytesRemaining() < static_cast<juce::int64>(getMaxStateSize()) - 8) {
+        return false;
+    }
+
+    for (int channel = 0; channel < channels_count; ++channel) {
+        float* channel_history = history.data() + channel * history_stride;
+        for (int i = 0; i < taps_per_phase - 1; i++) {
+            channel_history[i] = stream.readFloat();
+        }
+        channel_peaks[channel] = stream.readFloat();
+
+        if (channel < max_published_channels) {
+            channel_true_peaks[channel].store(gainToDecibels(channel_peaks[channel]));
+        }
+    }
+    overall_peak = stream.readFloat();
+
+    true_peak->store(gainToDecibels(overall_peak));
+    return true;
+}
+
+size_t TruePeakCalculations::getMaxStateSize() const
+{
+    return 8 + static_cast<size_t>(channels_count) * taps_per_phase * 4 + 4;
+}
+
+float TruePeakCalculations::getChannelTruePeak(int channel) const
+{
+    return channel_true_peaks[channel].load();
+}
+
+int TruePeakCalculations::getChannelsCount() const
+{
+    return std::min(channels_count, static_cast<int>(max_published_channels));
+}
+
+double TruePeakCalculations::getTruePeak() const
+{
+    return gainToDecibels(overall_peak);
+}
+
+template <typename SampleType>
+float TruePeakCalculations::processChannel(int channel, const SampleType* samples, int samplesNum)
+{
+    // History of the channel is followed by new samples, so every tap reads contiguous memory
+    float* channel_history = history.data() + channel * history_stride;
+    copySamples(channel_history + taps_per_phase - 1, samples, samplesNum);
+
+    float peak = 0.0f;
+    for (int phase = 0; phase < phases_count; phase += phase_step) {
+        // interpolated[n] = sum of coefficients[phase][k] * x[n - k]
+        // Computed tap after tap over the whole part, so each step is a vectorized multiply-add
+        const float* phase_coefficients = coefficients[phase];
+        juce::FloatVectorOperations::multiply(interpolated.data(), channel_history + taps_per_phase - 1, phase_coefficients[0], samplesNum);
+        for (int k = 1; k < taps_per_phase; k++) {
+            juce::FloatVectorOperations::addWithMultiply(interpolated.data(), channel_history + taps_per_phase - 1 - k, phase_coefficients[k], samplesNum);
+        }
+
+        float phase_min, phase_max;
+        juce::FloatVectorOperations::findMinAndMax(interpolated.data(), samplesNum, phase_min, phase_max);
+        peak = std::max(peak, std::max(-phase_min, phase_max));
+    }
+
+    // Keep last samples as history for the next part
+    memmove(channel_history, channel_history + samplesNum, sizeof(float) * (taps_per_phase - 1));
+
+    return peak;
+}
+
+void TruePeakCalculations::copySamples(float* destination, const float* samples, int samplesNum)
+{
+    memcpy(destination, samples, sizeof(float) * samplesNum);
+}
+
+void TruePeakCalculations::copySamples(float* destination, const double* samples, int samplesNum)
+{
+    for (int i = 0; i < samplesNum; i++) {
+        destination[i] = static_cast<float>(samples[i]);
+    }
+}
+
+float TruePeakCalculations::gainToDecibels(float gain)
+{
+    return gain > 0.0f ? 20.0f * std::log10(gain) : -std::numeric_limits<float>::infinity();
+}
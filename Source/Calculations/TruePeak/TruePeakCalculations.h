@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    TruePeakCalculations.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// True peak (dBTP) from BS.1770 Annex 2 - signal is oversampled with polyphase FIR interpolator
+// and peak is taken from the oversampled signal.
+// Below 96kHz signal is oversampled 4 times, from 96kHz up only every second phase is used (2x is enough there).
+class TruePeakCalculations {
+public:
+    TruePeakCalculations();
+
+    void prepareToPlay(double sampleRate, int samplesPerBlock, int channelCount);
+
+    void clearCounters();
+
+    void processBlock(const juce::AudioBuffer<float>& buffer, int channelCount);
+    void processBlock(const juce::AudioBuffer<double>& buffer, int channelCount);
+
+    // dBTP of single channel since last clearCounters, for channels below max_published_channels
+    float getChannelTruePeak(int channel) const;
+    int getChannelsCount() const;
+
+    // dBTP of all channels since last clearCounters - audio thread only
+    double getTruePeak() const;
+
+    // Saved interpolator history and peaks. Neither allocates, readState returns false and clears counters
+    // if state was written for other channel count or oversampling.
+    void writeState(juce::OutputStream& stream) const;
+    bool readState(juce::InputStream& stream);
+    size_t getMaxStateSize() const;
+
+    static constexpr int max_published_channels = 64;
+
+    std::atomic<float>* true_peak = nullptr;
+
+private:
+    template <typename SampleType>
+    void processBuffer(const juce::AudioBuffer<SampleType>& buffer, int channelCount);
+
+    // Interpolation runs in float for both sample types - peaks are not accumulated, float is precise enough for them
+    template <typename SampleType>
+    float processChannel(int channel, const SampleType* samples, int samplesNum);
+
+    static void copySamples(float* destination, const float* samples, int samplesNum);
+    static void copySamples(float* destination, const double* samples, int samplesNum);
+
+    static float gainToDecibels(float gain);
+
+    static constexpr int phases_count = 4;
+    static constexpr int taps_per_phase = 12;
+    static const float coefficients[phases_count][taps_per_phase];
+
+    int phase_step; // 1 - all phases are used (4x), 2 - every second phase (2x)
+    int part_length; // Max number of samples interpolated at once - samplesPerBlock, bigger blocks are split
+
+    // Per channel: taps_per_phase - 1 samples of history followed by part_length new samples, allocated in prepareToPlay
+    std::vector<float> history;
+    int history_stride;
+    std::vector<float> interpolated; // Scratch buffer for single phase of single part
+    int channels_count;
+
+    std::vector<float> channel_peaks; // Linear peaks, audio thread only
+    float overall_peak;
+
+    std::array<std::atomic<float>, max_published_channels> channel_true_peaks;
+};
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    ChannelMetricsTable.cpp
+
+  ==============================================================================
+*/
+
+#include "ChannelMetricsTable.h"
+
+namespace {
+    const char* const column_names[] = { "Ch", "RMS dBFS", "Peak dBFS", "DC", "ZC/s", "M LUFS", "S LUFS", "TP dBTP" };
+    constexpr int columns_count = static_cast<int>(sizeof(column_names) / sizeof(column_names[0]));
+    constexpr int first_column_width = 30;
+}
+
+ChannelMetricsTable::ChannelMetricsTable() :
+    channels(),
+    channels_count(0)
+{
+    setOpaque(true);
+}
+
+void ChannelMetricsTable::setTelemetry(const TelemetrySnapshot& telemetry)
+{
+    const int new_channels_count = std::min(telemetry.channels_count, static_cast<int>(TelemetrySnapshot::max_channels));
+    const size_t shown_bytes = sizeof(TelemetrySnapshot::ChannelMetrics) * static_cast<size_t>(new_channels_count);
+
+    if (new_channels_count == channels_count && std::memcmp(channels.data(), telemetry.channels.data(), shown_bytes) == 0) {
+        return;
+    }
+
+    std::memcpy(channels.data(), telemetry.channels.data(), shown_bytes);
+    if (new_channels_count != channels_count) {
+        channels_count = new_channels_count;
+        setSize(getWidth(), getRequiredHeight());
+    }
+    repaint();
+}
+
+int ChannelMetricsTable::getRequiredHeight() const
+{
+    return (channels_count + 1) * row_height;
+}
+
+void ChannelMetricsTable::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+    g.setFont(11.0f);
+
+    const int column_width = (getWidth() - first_column_width) / (columns_count - 1);
+    auto getColumnX = [column_width](int column) {
+        return column == 0 ? 0 : first_column_width + (column - 1) * column_width;
+    };
+
+    g.setColour(juce::Colours::grey);
+    for (int column = 0; column < columns_count; column++) {
+        g.drawText(column_names[column], getColumnX(column), 0, column == 0 ? first_column_width : column_width, row_height, juce::Justification::centred);
+    }
+
+    g.setColour(juce::Colours::white);
+    char text[32];
+    for (int channel = 0; channel < channels_count; channel++) {
+        const TelemetrySnapshot::ChannelMetrics& metrics = channels[static_cast<size_t>(channel)];
+        const double values[] = { static_cast<double>(channel + 1), gainToDecibels(metrics.rms), gainToDecibels(metrics.peak), metrics.dc_offset,
+                                  metrics.crossing_rate, metrics.momentary_loudness, metrics.short_term_loudness, metrics.true_peak };
+        const char* const formats[] = { "%.0f", "%.1f", "%.1f", "%.5f", "%.0f", "%.1f", "%.1f", "%.1f" };
+
+        const int y = (channel + 1) * row_height;
+        for (int column = 0; column < columns_count; column++) {
+            formatValue(text, sizeof(text), formats[column], values[column]);
+            g.drawText(text, getColumnX(column), y, column == 0 ? first_column_width : column_width, row_height, juce::Justification::centred);
+        }
+    }
+}
+
+void ChannelMetricsTable::formatValue(char* buffer, size_t buffer_size, const char* format, double value)
+{
+    if (std::isinf(value) && value < 0.0) {
+        std::snprintf(buffer, buffer_size, "-inf");
+        return;
+    }
+    std::snprintf(buffer, buffer_size, format, value);
+}
+
+double ChannelMetricsTable::gainToDecibels(double gain)
+{
+    return gain > 0.0 ? 20.0 * std::log10(gain) : -std::numeric_limits<double>::infinity();
+}
@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    ChannelMetricsTable.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Telemetry/TelemetrySnapshot.h"
+
+// Per channel values of the last telemetry snapshot, one row per channel.
+// Height grows with the number of channels, the editor shows it in a viewport.
+class ChannelMetricsTable : public juce::Component {
+public:
+    ChannelMetricsTable();
+
+    // Copies per channel values of the snapshot, repaints only if they have changed
+    void setTelemetry(const TelemetrySnapshot& telemetry);
+
+    int getRequiredHeight() const;
+
+    void paint(juce::Graphics& g) override;
+
+    static constexpr int row_height = 16;
+
+private:
+    // Formats value into fixed buffer, -inf (silence) is shown as "-inf"
+    static void formatValue(char* buffer, size_t buffer_size, const char* format, double value);
+    static double gainToDecibels(double gain);
+
+    std::array<TelemetrySnapshot::ChannelMetrics, TelemetrySnapshot::max_channels> channels;
+    int channels_count;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChannelMetricsTable)
+};
@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    LoudnessGraph.cpp
+
+  ==============================================================================
+*/
+
+#include "LoudnessGraph.h"
+
+LoudnessGraph::LoudnessGraph() :
+    history(history_length),
+    write_position(0),
+    points_count(0)
+{
+    setOpaque(true);
+}
+
+void LoudnessGraph::addPoints(const LoudnessHistoryFifo::Point* points, int pointsCount)
+{
+    for (int i = 0; i < pointsCount; i++) {
+        history[static_cast<size_t>(write_position)] = points[i];
+        write_position = (write_position + 1) % history_length;
+    }
+    points_count = std::min(points_count + pointsCount, history_length);
+}
+
+void LoudnessGraph::clear()
+{
+    write_position = 0;
+    points_count = 0;
+}
+
+void LoudnessGraph::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+
+    // Grid every 10 LU, target level of EBU R128 (-23 LUFS) highlighted
+    g.setFont(10.0f);
+    for (float loudness = lowest_loudness + 10.0f; loudness < highest_loudness; loudness += 10.0f) {
+        const float y = loudnessToY(loudness);
+        g.setColour(juce::Colours::darkgrey);
+        g.drawHorizontalLine(juce::roundToInt(y), 0.0f, static_cast<float>(getWidth()));
+        g.drawText(juce::String(juce::roundToInt(loudness)), 2, juce::roundToInt(y) - 12, 30, 12, juce::Justification::left);
+    }
+    g.setColour(juce::Colours::darkgreen);
+    g.drawHorizontalLine(juce::roundToInt(loudnessToY(-23.0f)), 0.0f, static_cast<float>(getWidth()));
+
+    if (points_count < 2) {
+        return;
+    }
+
+    const float x_step = static_cast<float>(getWidth()) / (history_length - 1);
+    const float first_x = static_cast<float>(getWidth()) - x_step * (points_count - 1);
+    const int first_point = (write_position - points_count + history_length) % history_length;
+
+    juce::Path momentary_path;
+    juce::Path short_term_path;
+    bool short_term_started = false;
+
+    for (int i = 0; i < points_count; i++) {
+        const LoudnessHistoryFifo::Point& point = history[static_cast<size_t>((first_point + i) % history_length)];
+        const float x = first_x + x_step * i;
+
+        if (i == 0) {
+            momentary_path.startNewSubPath(x, loudnessToY(point.momentary_loudness));
+        }
+        else {
+            momentary_path.lineTo(x, loudnessToY(point.momentary_loudness));
+        }
+
+        // Short term loudness exists only after the first 3s
+        if (std::isfinite(point.short_term_loudness)) {
+            if (!short_term_started) {
+                short_term_path.startNewSubPath(x, loudnessToY(point.short_term_loudness));
+                short_term_started = true;
+            }
+            else {
+                short_term_path.lineTo(x, loudnessToY(point.short_term_loudness));
+            }
+        }
+        else {
+            short_term_started = false;
+        }
+    }
+
+    g.setColour(juce::Colours::lightblue.withAlpha(0.6f));
+    g.strokePath(momentary_path, juce::PathStrokeType(1.0f));
+    g.setColour(juce::Colours::orange);
+    g.strokePath(short_term_path, juce::PathStrokeType(2.0f));
+}
+
+float LoudnessGraph::loudnessToY(float loudness) const
+{
+    // Silence (-inf) and everything below the graph is drawn at its bottom
+    loudness = juce::jlimit(lowest_loudness, highest_loudness, std::isfinite(loudness) ? loudness : lowest_loudness);
+    return juce::jmap(loudness, lowest_loudness, highest_loudness, static_cast<float>(getHeight()), 0.0f);
+}
@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    LoudnessGraph.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Calculations/LUFS/LoudnessHistoryFifo.h"
+
+// Scrolling graph of momentary and short term loudness over the last minute, newest value on the right.
+// History is a preallocated ring, filled by the editor from LoudnessHistoryFifo.
+class LoudnessGraph : public juce::Component {
+public:
+    LoudnessGraph();
+
+    void addPoints(const LoudnessHistoryFifo::Point* points, int pointsCount);
+    void clear();
+
+    void paint(juce::Graphics& g) override;
+
+    static constexpr int history_length = 600; // 60s of 100ms bins
+
+private:
+    float loudnessToY(float loudness) const;
+
+    std::vector<LoudnessHistoryFifo::Point> history;
+    int write_position;
+    int points_count;
+
+    static constexpr float lowest_loudness = -60.0f;
+    static constexpr float highest_loudness = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoudnessGraph)
+};
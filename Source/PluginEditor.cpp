@@ -11,21 +11,54 @@
 
 
 //==============================================================================
-AudioStatisticsPluginAudioProcessorEditor::AudioStatisticsPluginAudioProcessorEditor (AudioStatisticsPluginAudioProcessor& p, juce::AudioProcessorValueTreeState& vts)
-    : AudioProcessorEditor (&p), audioProcessor (p), valueTreeState(vts)//, RefreshTimer(this->updateValues)
+AudioStatisticsPluginAudioProcessorEditor::AudioStatisticsPluginAudioProcessorEditor (AudioStatisticsPluginAudioProcessor& p)
+    : AudioProcessorEditor (&p), audioProcessor (p),
+    telemetry(),
+    last_telemetry_version(0)
 {
     updateValues();
-    addAndMakeVisible(&ZeroPassesTextBox);
-    addAndMakeVisible(&RmsTextBox);
-    addAndMakeVisible(&MinTextBox);
-    addAndMakeVisible(&MaxTextBox);
-    addAndMakeVisible(&MomentaryLoudnessBox);
-    addAndMakeVisible(&IntegratedLoudnessBox);
-    addAndMakeVisible(&ShortTermLoudnessBox);
+    addAndMakeVisible(&ZeroPassesTextBox.label);
+    addAndMakeVisible(&RmsTextBox.label);
+    addAndMakeVisible(&MinTextBox.label);
+    addAndMakeVisible(&MaxTextBox.label);
+    addAndMakeVisible(&MomentaryLoudnessBox.label);
+    addAndMakeVisible(&IntegratedLoudnessBox.label);
+    addAndMakeVisible(&ShortTermLoudnessBox.label);
+    addAndMakeVisible(&LoudnessRangeBox.label);
+    addAndMakeVisible(&TruePeakBox.label);
+
+    // Values queued while the editor was closed would show up as one continuous line - start from now
+    audioProcessor.getLoudnessHistory().discardAll();
+    addAndMakeVisible(&loudnessGraph);
+
+    addAndMakeVisible(&spectrumView);
+
+    channelMetricsViewport.setViewedComponent(&channelMetricsTable, false);
+    channelMetricsViewport.setScrollBarsShown(true, false);
+    addAndMakeVisible(&channelMetricsViewport);
+
+    for (int refresh_rate : { 5, 10, 20, 30, 60 }) {
+        refreshRateBox.addItem("Refresh " + juce::String(refresh_rate) + " Hz", refresh_rate);
+    }
+    refreshRateBox.setSelectedId(audioProcessor.getEditorRefreshRate(), juce::NotificationType::dontSendNotification);
+    refreshRateBox.onChange = [this]() {
+        this->setRefreshRate(this->refreshRateBox.getSelectedId());
+    };
+    addAndMakeVisible(&refreshRateBox);
+
+    for (int update_interval : { 100, 50, 20, 10 }) {
+        updateIntervalBox.addItem("LUFS every " + juce::String(update_interval) + " ms", update_interval);
+    }
+    updateIntervalBox.setSelectedId(audioProcessor.getLoudnessUpdateInterval(), juce::NotificationType::dontSendNotification);
+    updateIntervalBox.onChange = [this]() {
+        this->audioProcessor.setLoudnessUpdateInterval(this->updateIntervalBox.getSelectedId());
+    };
+    addAndMakeVisible(&updateIntervalBox);
 
     resetButton.setButtonText("Reset Statistics");
     resetButton.onClick = [this]() {
-        this->audioProcessor.clearCounters();
+        this->audioProcessor.requestClearCounters();
+        this->loudnessGraph.clear();
     };
     addAndMakeVisible(&resetButton);
 
@@ -35,9 +68,9 @@ AudioStatisticsPluginAudioProcessorEditor::AudioStatisticsPluginAudioProcessorEd
         };
     addAndMakeVisible(&updateButton);
 
-    setSize (520, 300);
+    setSize (520, 800);
 
-    this->startTimer(50);
+    setRefreshRate(audioProcessor.getEditorRefreshRate());
 }
 
 AudioStatisticsPluginAudioProcessorEditor::~AudioStatisticsPluginAudioProcessorEditor()
@@ -48,42 +81,120 @@ AudioStatisticsPluginAudioProcessorEditor::~AudioStatisticsPluginAudioProcessorE
 void AudioStatisticsPluginAudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
-    ZeroPassesTextBox.setBounds(10, 10, 500, 20);
-    RmsTextBox.setBounds(10, 40, 500, 20);
-    MinTextBox.setBounds(10, 70, 500, 20);
-    MaxTextBox.setBounds(10, 100, 500, 20);
-    MomentaryLoudnessBox.setBounds(10, 130, 500, 20);
-    IntegratedLoudnessBox.setBounds(10, 160, 500, 20);
-    ShortTermLoudnessBox.setBounds(10, 190, 500, 20);
+    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+}
+
+void AudioStatisticsPluginAudioProcessorEditor::resized()
+{
+    ZeroPassesTextBox.label.setBounds(10, 10, 240, 20);
+    RmsTextBox.label.setBounds(10, 40, 500, 20);
+    MinTextBox.label.setBounds(10, 70, 500, 20);
+    MaxTextBox.label.setBounds(10, 100, 500, 20);
+    MomentaryLoudnessBox.label.setBounds(10, 130, 500, 20);
+    IntegratedLoudnessBox.label.setBounds(10, 160, 500, 20);
+    ShortTermLoudnessBox.label.setBounds(10, 190, 500, 20);
+    LoudnessRangeBox.label.setBounds(10, 220, 500, 20);
+    TruePeakBox.label.setBounds(10, 250, 500, 20);
+    loudnessGraph.setBounds(10, 280, getWidth() - 20, getHeight() - 630);
+    spectrumView.setBounds(10, getHeight() - 340, getWidth() - 20, 110);
+    channelMetricsViewport.setBounds(10, getHeight() - 220, getWidth() - 20, 150);
+    channelMetricsTable.setSize(channelMetricsViewport.getMaximumVisibleWidth(), channelMetricsTable.getRequiredHeight());
+
+    updateIntervalBox.setBounds(getWidth() - 270, 10, 135, 20);
+    refreshRateBox.setBounds(getWidth() - 130, 10, 120, 20);
 
     resetButton.setBounds(getWidth()/2+10, getHeight() - 60, getWidth() / 2 -20, 50);
     updateButton.setBounds(10, getHeight() - 60, getWidth() / 2 - 20, 50);
 }
 
-void AudioStatisticsPluginAudioProcessorEditor::resized()
+void AudioStatisticsPluginAudioProcessorEditor::updateValues()
 {
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
+    last_telemetry_version = audioProcessor.getTelemetry().read(telemetry);
+    showTelemetry();
 }
 
-void AudioStatisticsPluginAudioProcessorEditor::updateValues()
+void AudioStatisticsPluginAudioProcessorEditor::showTelemetry()
+{
+    char text[64];
+    std::snprintf(text, sizeof(text), "Zero Passes: %llu", telemetry.zero_passes);
+    ZeroPassesTextBox.show(text);
+
+    showValue(RmsTextBox, "RMS: ", telemetry.rms);
+    showValue(MinTextBox, "MIN: ", telemetry.min);
+    showValue(MaxTextBox, "MAX: ", telemetry.max);
+    showValue(MomentaryLoudnessBox, "Momentary LUFS: ", telemetry.momentary_loudness);
+    showValue(IntegratedLoudnessBox, "Integrated LUFS: ", telemetry.integrated_loudness);
+    showValue(ShortTermLoudnessBox, "Short Term LUFS: ", telemetry.short_term_loudness);
+    showValue(LoudnessRangeBox, "Loudness Range LU: ", telemetry.loudness_range);
+    showValue(TruePeakBox, "True Peak dBTP: ", telemetry.true_peak);
+
+    spectrumView.setSpectrum(telemetry.spectrum, telemetry.spectrum_dropped_samples);
+    channelMetricsTable.setTelemetry(telemetry);
+}
+
+void AudioStatisticsPluginAudioProcessorEditor::showValue(ValueLabel& value_label, const char* name, double value)
 {
-    ZeroPassesTextBox.setText("Zero Passes: " + parameterToString("zero_passes"), juce::NotificationType::dontSendNotification);
-    RmsTextBox.setText("RMS: " + parameterToString("rms"), juce::NotificationType::dontSendNotification);
-    MinTextBox.setText("MIN: " + parameterToString("min"), juce::NotificationType::dontSendNotification);
-    MaxTextBox.setText("MAX: " + parameterToString("max"), juce::NotificationType::dontSendNotification);
-    MomentaryLoudnessBox.setText("Momentary LUFS: " + parameterToString("momentary_loudness"), juce::NotificationType::dontSendNotification);
-    IntegratedLoudnessBox.setText("Integrated LUFS: " + parameterToString("integrated_loudness"), juce::NotificationType::dontSendNotification);
-    ShortTermLoudnessBox.setText("Short Term LUFS: " + parameterToString("short_term_loudness"), juce::NotificationType::dontSendNotification);
+    char text[64];
+    formatValue(text, sizeof(text), name, value);
+    value_label.show(text);
 }
 
-std::string AudioStatisticsPluginAudioProcessorEditor::parameterToString(std::string param_name)
+void AudioStatisticsPluginAudioProcessorEditor::formatValue(char* buffer, size_t buffer_size, const char* name, double value)
 {
-    std::string t = std::to_string(valueTreeState.getRawParameterValue(param_name)->load());
-    return t.erase(t.find_last_not_of('0') + 1, std::string::npos).erase(t.find_last_not_of('.') + 1, std::string::npos);
+    // Six decimal places with trailing zeros removed, like std::to_string + find_last_not_of did before
+    int length = std::snprintf(buffer, buffer_size, "%s%f", name, value);
+    if (length <= 0 || static_cast<size_t>(length) >= buffer_size || std::strchr(buffer + std::strlen(name), '.') == nullptr) {
+        return;
+    }
+
+    while (buffer[length - 1] == '0') {
+        buffer[--length] = '\0';
+    }
+    if (buffer[length - 1] == '.') {
+        buffer[--length] = '\0';
+    }
+}
+
+void AudioStatisticsPluginAudioProcessorEditor::ValueLabel::show(const char* new_text)
+{
+    if (std::strcmp(text, new_text) == 0) {
+        return;
+    }
+
+    std::strncpy(text, new_text, sizeof(text) - 1);
+    label.setText(text, juce::NotificationType::dontSendNotification);
+}
+
+void AudioStatisticsPluginAudioProcessorEditor::setRefreshRate(int refreshRateHz)
+{
+    audioProcessor.setEditorRefreshRate(refreshRateHz);
+    this->startTimerHz(refreshRateHz);
 }
 
 void AudioStatisticsPluginAudioProcessorEditor::timerCallback()
 {
+    drainLoudnessHistory();
+
+    // Nothing was published since the last refresh (transport stopped, plugin bypassed) - nothing to redraw
+    if (audioProcessor.getTelemetry().getVersion() == last_telemetry_version) {
+        return;
+    }
+
     updateValues();
 }
+
+void AudioStatisticsPluginAudioProcessorEditor::drainLoudnessHistory()
+{
+    LoudnessHistoryFifo::Point points[64];
+    int points_count = 0;
+    bool has_new_points = false;
+
+    while ((points_count = audioProcessor.getLoudnessHistory().pop(points, 64)) > 0) {
+        loudnessGraph.addPoints(points, points_count);
+        has_new_points = true;
+    }
+
+    if (has_new_points) {
+        loudnessGraph.repaint();
+    }
+}
@@ -10,6 +10,9 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "LoudnessGraph.h"
+#include "ChannelMetricsTable.h"
+#include "SpectrumView.h"
 
 //==============================================================================
 /**
@@ -17,7 +20,7 @@
 class AudioStatisticsPluginAudioProcessorEditor : public juce::AudioProcessorEditor, public juce::Timer
 {
 public:
-    AudioStatisticsPluginAudioProcessorEditor (AudioStatisticsPluginAudioProcessor&, juce::AudioProcessorValueTreeState&);
+    AudioStatisticsPluginAudioProcessorEditor (AudioStatisticsPluginAudioProcessor&);
     ~AudioStatisticsPluginAudioProcessorEditor() override;
 
     //==============================================================================
@@ -26,26 +29,56 @@ public:
 
     void updateValues();
 
-    std::string parameterToString(std::string param_name);
-
     void timerCallback() override;
 
+    // Moves all loudness values queued by the audio thread to the graph
+    void drainLoudnessHistory();
+
 private:
+    // Label that remembers its text - setText (which allocates and repaints) is called only when the text changes
+    struct ValueLabel {
+        juce::Label label;
+        char text[64] = {};
+
+        void show(const char* new_text);
+    };
+
+    // Formats "name value" into fixed buffer, no heap allocation
+    static void formatValue(char* buffer, size_t buffer_size, const char* name, double value);
+    void showValue(ValueLabel& value_label, const char* name, double value);
+
+    // Shows values of the last snapshot read from the processor
+    void showTelemetry();
+
+    void setRefreshRate(int refreshRateHz);
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     AudioStatisticsPluginAudioProcessor& audioProcessor;
-    juce::AudioProcessorValueTreeState& valueTreeState;
 
-    // TODO - https://docs.juce.com/master/tutorial_audio_thumbnail.html
+    // All values shown come from one snapshot, so they always belong to the same block
+    TelemetrySnapshot telemetry;
+    unsigned long long int last_telemetry_version;
+
+    ValueLabel ZeroPassesTextBox;
+    ValueLabel RmsTextBox;
+    ValueLabel MinTextBox;
+    ValueLabel MaxTextBox;
+    ValueLabel MomentaryLoudnessBox;
+    ValueLabel IntegratedLoudnessBox;
+    ValueLabel ShortTermLoudnessBox;
+    ValueLabel LoudnessRangeBox;
+    ValueLabel TruePeakBox;
+
+    LoudnessGraph loudnessGraph;
+
+    SpectrumView spectrumView;
 
-    juce::Label ZeroPassesTextBox;
-    juce::Label RmsTextBox;
-    juce::Label MinTextBox;
-    juce::Label MaxTextBox;
-    juce::Label MomentaryLoudnessBox;
-    juce::Label IntegratedLoudnessBox;
-    juce::Label ShortTermLoudnessBox;
+    ChannelMetricsTable channelMetricsTable;
+    juce::Viewport channelMetricsViewport;
 
+    juce::ComboBox refreshRateBox;
+    juce::ComboBox updateIntervalBox;
     juce::TextButton resetButton;
     juce::TextButton updateButton;
 
@@ -56,19 +56,47 @@ AudioStatisticsPluginAudioProcessor::AudioStatisticsPluginAudioProcessor()
                                                                             "ShortTermLoudness",            // parameter name
                                                                             -200,              // minimum value
                                                                             200,              // maximum value
+                                                                            -200),
+                                std::make_unique<juce::AudioParameterFloat>("loudness_range",            // parameterID
+                                                                            "LoudnessRange",            // parameter name
+                                                                            0,              // minimum value
+                                                                            200,              // maximum value
+                                                                            0),
+                                std::make_unique<juce::AudioParameterFloat>("true_peak",            // parameterID
+                                                                            "TruePeak",            // parameter name
+                                                                            -200,              // minimum value
+                                                                            200,              // maximum value
                                                                             -200)
 
                            }),
-    lufsCalc()
+    statisticsCalc(),
+    lufsCalc(),
+    truePeakCalc(),
+    spectrumCalc(),
+    loudnessHistory(),
+    telemetry_snapshot(),
+    telemetry(),
+    clear_counters_requested(false),
+    saved_measurement_state(),
+    saved_measurement_state_size(0),
+    restored_measurement_state(),
+    save_state_requested(false),
+    state_saved(),
+    restore_state_requested(false),
+    samples_since_state_saved(0),
+    editor_refresh_rate_hz(20)
 #endif
 {
-    zero_passes = valueTreeState.getRawParameterValue("zero_passes");
-    rms = valueTreeState.getRawParameterValue("rms");
-    min = valueTreeState.getRawParameterValue("min");
-    max = valueTreeState.getRawParameterValue("max");
+    statisticsCalc.zero_passes = valueTreeState.getRawParameterValue("zero_passes");
+    statisticsCalc.rms = valueTreeState.getRawParameterValue("rms");
+    statisticsCalc.min = valueTreeState.getRawParameterValue("min");
+    statisticsCalc.max = valueTreeState.getRawParameterValue("max");
     lufsCalc.last_momentary_loudness = valueTreeState.getRawParameterValue("momentary_loudness");
     lufsCalc.integrated_loudness = valueTreeState.getRawParameterValue("integrated_loudness");
     lufsCalc.short_term_loudness = valueTreeState.getRawParameterValue("short_term_loudness");
+    lufsCalc.loudness_range = valueTreeState.getRawParameterValue("loudness_range");
+    truePeakCalc.true_peak = valueTreeState.getRawParameterValue("true_peak");
+    lufsCalc.history = &loudnessHistory;
     clearCounters();
 }
 
@@ -141,13 +169,34 @@ void AudioStatisticsPluginAudioProcessor::changeProgramName (int index, const ju
 //==============================================================================
 void AudioStatisticsPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    lufsCalc.prepareToPlay(sampleRate, samplesPerBlock);
+    statisticsCalc.prepareToPlay(sampleRate, samplesPerBlock, getTotalNumInputChannels());
+    lufsCalc.prepareToPlay(sampleRate, samplesPerBlock, getChannelLayoutOfBus(true, 0));
+    truePeakCalc.prepareToPlay(sampleRate, samplesPerBlock, getTotalNumInputChannels());
+    spectrumCalc.prepareToPlay(sampleRate, samplesPerBlock, getTotalNumInputChannels());
+
+    telemetry_snapshot.sample_rate = sampleRate;
+    telemetry_snapshot.channels_count = getTotalNumInputChannels();
+    telemetry_snapshot.channels.fill(TelemetrySnapshot::ChannelMetrics());
+
+    {
+        const juce::SpinLock::ScopedLockType lock(measurement_state_lock);
+        // One spare byte - block filled up to the end means some state didn't fit
+        saved_measurement_state.setSize(getMaxMeasurementStateSize() + 1);
+        saved_measurement_state_size = 0;
+    }
+
+    // State loaded with the session is usually set before the first prepareToPlay - audio thread is not running yet
+    if (restore_state_requested.load(std::memory_order_acquire)) {
+        restoreMeasurementState();
+    }
 }
 
 void AudioStatisticsPluginAudioProcessor::releaseResources()
 {
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
+    // Audio thread has stopped - state saved now is exactly where the measurement stopped
+    saveMeasurementState();
+
+    spectrumCalc.releaseResources();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -157,12 +206,9 @@ bool AudioStatisticsPluginAudioProcessor::isBusesLayoutSupported (const BusesLay
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout can be measured (mono, stereo, surround, immersive, ambisonics) -
+    // LUFS channel weights are taken from the channel types of the layout.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -177,6 +223,24 @@ bool AudioStatisticsPluginAudioProcessor::isBusesLayoutSupported (const BusesLay
 #endif
 
 void AudioStatisticsPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    processBuffer (buffer);
+}
+
+void AudioStatisticsPluginAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    processBuffer (buffer);
+}
+
+bool AudioStatisticsPluginAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+template <typename SampleType>
+void AudioStatisticsPluginAudioProcessor::processBuffer (juce::AudioBuffer<SampleType>& buffer)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -192,55 +256,34 @@ void AudioStatisticsPluginAudioProcessor::processBlock (juce::AudioBuffer<float>
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, samplesNum);
 
-    if (previous_length == nullptr || *previous_length != totalNumInputChannels) {
-        previous_length.reset(new unsigned int(totalNumInputChannels));
+    if (clear_counters_requested.exchange(false, std::memory_order_acquire)) {
+        clearCounters();
+    }
 
-        samples_count_per_channel.reset(new long long unsigned int[totalNumInputChannels]);
-        square_sum_per_channel.reset(new float[totalNumInputChannels]);
+    if (restore_state_requested.load(std::memory_order_acquire)) {
+        restoreMeasurementState();
+    }
 
-        previous_samples.reset(new float[totalNumInputChannels]);
-        for (int channel = 0; channel < totalNumInputChannels; ++channel)
-        {
-            previous_samples[channel] = *buffer.getWritePointer(channel);
-            samples_count_per_channel[channel] = 0;
-            square_sum_per_channel[channel] = 0;
-        }
+    // Basic statistics
+    statisticsCalc.processBlock(buffer, totalNumInputChannels);
 
-    }
+    // LUFS - whole block, all channels at once. Block was just read above, so it is still in cache.
+    lufsCalc.processBlock(buffer, totalNumInputChannels);
 
-    float temp_rms = 0;
-       
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
-    {
-        float* channelData = buffer.getWritePointer(channel);
-        for (float* i = channelData; i < channelData + samplesNum; i++) {
-
-            if ((previous_samples[channel] * (*i)) < 0) {
-                zero_passes->store(zero_passes->load() + 1);
-            }
-
-            // RMS
-            samples_count_per_channel[channel]++;
-            square_sum_per_channel[channel] += (*i * *i);
-
-            // Min Max
-            if (*i > max->load()) {
-                max->store(*i);
-            }
-            if (*i < min->load()) {
-                min->store(*i);
-            }
-
-            previous_samples[channel] = *i;
-        }
+    // True peak
+    truePeakCalc.processBlock(buffer, totalNumInputChannels);
 
-        temp_rms = temp_rms + std::sqrt(square_sum_per_channel[channel] / samples_count_per_channel[channel]);
+    // Spectrum - only queues the downmixed block, FFTs run on the spectrum worker thread
+    spectrumCalc.processBlock(buffer, totalNumInputChannels);
 
+    // All values of this block are published at once
+    publishTelemetry(samplesNum);
 
-        // LUFS
-        lufsCalc.processBlock(buffer, totalNumInputChannels);
+    // Checkpoint every few seconds, so that even after host crash only the last seconds are lost
+    samples_since_state_saved += static_cast<unsigned long long int>(samplesNum);
+    if (save_state_requested.load(std::memory_order_acquire) || samples_since_state_saved >= state_checkpoint_interval_seconds * getSampleRate()) {
+        saveMeasurementState();
     }
-    rms->store(temp_rms * 1.0 / totalNumInputChannels);
 }
 
 //==============================================================================
@@ -251,50 +294,242 @@ bool AudioStatisticsPluginAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* AudioStatisticsPluginAudioProcessor::createEditor()
 {
-    return new AudioStatisticsPluginAudioProcessorEditor (*this, valueTreeState);
+    return new AudioStatisticsPluginAudioProcessorEditor (*this);
 }
 
 //==============================================================================
 void AudioStatisticsPluginAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // Wrappers hold the callback lock for the whole processBlock. If it is free, audio thread is between blocks (or not running)
+    // and the state is saved right here. Otherwise the audio thread saves it at the end of its block and signals state_saved.
+    // Message thread waits at most state_save_timeout_ms for it (a few blocks even at big buffer sizes) -
+    // only if the audio thread doesn't finish a block by then, the last checkpoint (at most state_checkpoint_interval_seconds old) is saved.
+    bool saved_now = false;
+    {
+        const juce::ScopedTryLock callback_lock(getCallbackLock());
+        if (callback_lock.isLocked()) {
+            saveMeasurementState();
+            saved_now = true;
+        }
+    }
+
+    if (!saved_now) {
+        state_saved.reset();
+        save_state_requested.store(true, std::memory_order_release);
+        state_saved.wait(state_save_timeout_ms);
+    }
+
+    juce::MemoryOutputStream stream(destData, false);
+    stream.writeInt(state_magic);
+    stream.writeInt(state_version);
+    stream.writeInt(editor_refresh_rate_hz);
+    stream.writeInt(getLoudnessUpdateInterval());
+
+    const juce::SpinLock::ScopedLockType lock(measurement_state_lock);
+    stream.writeInt(static_cast<int>(saved_measurement_state_size));
+    stream.write(saved_measurement_state.getData(), saved_measurement_state_size);
 }
 
 void AudioStatisticsPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+    if (sizeInBytes < 16 || stream.readInt() != state_magic) {
+        return;
+    }
+
+    // State of a newer version can't be read - measurement starts from scratch
+    const int version = stream.readInt();
+    if (version < 1 || version > state_version) {
+        return;
+    }
+
+    const int refresh_rate_hz = stream.readInt();
+    if (refresh_rate_hz > 0 && refresh_rate_hz <= 60) {
+        editor_refresh_rate_hz = refresh_rate_hz;
+    }
+
+    if (version >= 2) {
+        setLoudnessUpdateInterval(stream.readInt());
+    }
+
+    // Measurement state of older versions has other layout - only settings are restored from it
+    const int measurement_state_size = stream.readInt();
+    if (version != state_version || measurement_state_size <= 0 || measurement_state_size > stream.getNumBytesRemaining()) {
+        return;
+    }
+
+    {
+        const juce::SpinLock::ScopedLockType lock(measurement_state_lock);
+        restored_measurement_state.replaceAll(static_cast<const char*>(data) + stream.getPosition(), static_cast<size_t>(measurement_state_size));
+    }
+
+    // Applied by the audio thread at the start of the next block, or by prepareToPlay
+    restore_state_requested.store(true, std::memory_order_release);
 }
 
 void AudioStatisticsPluginAudioProcessor::clearCounters()
 {
-    zero_passes->store(0);
-    rms->store(-std::numeric_limits<double>::infinity());
+    statisticsCalc.clearCounters();
+    lufsCalc.clearCounters();
+    truePeakCalc.clearCounters();
+    spectrumCalc.clearCounters();
 
-    min->store(std::numeric_limits<double>::infinity());
-    max->store(-std::numeric_limits<double>::infinity());
+    telemetry_snapshot.blocks_count = 0;
+    telemetry_snapshot.samples_count = 0;
+    telemetry_snapshot.spectrum = SpectrumResult();
+    publishTelemetry(0);
+}
 
+void AudioStatisticsPluginAudioProcessor::saveMeasurementState()
+{
+    const juce::SpinLock::ScopedTryLockType lock(measurement_state_lock);
+    if (!lock.isLocked() || saved_measurement_state.isEmpty()) {
+        return;
+    }
 
+    // Stream writes to the block preallocated for the largest possible state, it never grows it
+    juce::MemoryOutputStream stream(saved_measurement_state.getData(), saved_measurement_state.getSize());
+    stream.writeDouble(telemetry_snapshot.sample_rate);
+    stream.writeInt(telemetry_snapshot.channels_count);
+    stream.writeInt64(static_cast<juce::int64>(telemetry_snapshot.blocks_count));
+    stream.writeInt64(static_cast<juce::int64>(telemetry_snapshot.samples_count));
+    statisticsCalc.writeState(stream);
+    lufsCalc.writeState(stream);
+    truePeakCalc.writeState(stream);
+
+    jassert(stream.getPosition() < static_cast<juce::int64>(saved_measurement_state.getSize())); // getMaxStateSize of some calculation is too small
+    saved_measurement_state_size = static_cast<size_t>(stream.getPosition());
+
+    samples_since_state_saved = 0;
+    if (save_state_requested.exchange(false, std::memory_order_acq_rel)) {
+        state_saved.signal();
+    }
+}
 
-    if (previous_length == nullptr) {
+void AudioStatisticsPluginAudioProcessor::restoreMeasurementState()
+{
+    const juce::SpinLock::ScopedTryLockType lock(measurement_state_lock);
+    if (!lock.isLocked()) {
         return;
     }
+    restore_state_requested.store(false, std::memory_order_release);
+
+    juce::MemoryInputStream stream(restored_measurement_state, false);
 
-    int channel_len = *previous_length.get();
+    // Filters and bin lengths only make sense for the same sample rate and channels
+    const double sample_rate = stream.readDouble();
+    const int channels_count = stream.readInt();
+    if (sample_rate != telemetry_snapshot.sample_rate || channels_count != telemetry_snapshot.channels_count) {
+        return;
+    }
 
-    samples_count_per_channel.reset(new long long unsigned int[channel_len]);
-    square_sum_per_channel.reset(new float[channel_len]);
+    const unsigned long long int blocks_count = static_cast<unsigned long long int>(stream.readInt64());
+    const unsigned long long int samples_count = static_cast<unsigned long long int>(stream.readInt64());
 
-    for (int channel = 0; channel < channel_len; ++channel)
-    {
-        samples_count_per_channel[channel] = 0;
-        square_sum_per_channel[channel] = 0;
+    if (!statisticsCalc.readState(stream) || !lufsCalc.readState(stream) || !truePeakCalc.readState(stream)) {
+        clearCounters();
+        return;
     }
 
+    telemetry_snapshot.blocks_count = blocks_count;
+    telemetry_snapshot.samples_count = samples_count;
+    publishTelemetry(0);
+}
 
-    lufsCalc.clearCounters();
+size_t AudioStatisticsPluginAudioProcessor::getMaxMeasurementStateSize() const
+{
+    return 8 + 4 + 8 + 8 + statisticsCalc.getMaxStateSize() + lufsCalc.getMaxStateSize() + truePeakCalc.getMaxStateSize();
+}
+
+void AudioStatisticsPluginAudioProcessor::requestClearCounters()
+{
+    clear_counters_requested.store(true, std::memory_order_release);
+}
+
+const TelemetryPublisher& AudioStatisticsPluginAudioProcessor::getTelemetry() const
+{
+    return telemetry;
+}
+
+void AudioStatisticsPluginAudioProcessor::publishTelemetry(int samplesNum)
+{
+    TelemetrySnapshot& snapshot = telemetry_snapshot;
+
+    if (samplesNum > 0) {
+        snapshot.blocks_count++;
+        snapshot.samples_count += static_cast<unsigned long long int>(samplesNum);
+    }
+
+    snapshot.zero_passes = statisticsCalc.getZeroPassesCount();
+    snapshot.rms = statisticsCalc.getRms();
+    snapshot.min = statisticsCalc.getMin();
+    snapshot.max = statisticsCalc.getMax();
+
+    snapshot.momentary_loudness = lufsCalc.getMomentaryLoudness();
+    snapshot.short_term_loudness = lufsCalc.getShortTermLoudness();
+    snapshot.integrated_loudness = lufsCalc.getIntegratedLoudness();
+    snapshot.loudness_range = lufsCalc.getLoudnessRange();
+    snapshot.max_momentary_loudness = lufsCalc.getMaxMomentaryLoudness();
+    snapshot.max_short_term_loudness = lufsCalc.getMaxShortTermLoudness();
+
+    snapshot.true_peak = truePeakCalc.getTruePeak();
+
+    // Spectrum changes only when the worker finished a new frame
+    spectrumCalc.getLatestResult(snapshot.spectrum);
+    snapshot.spectrum_dropped_samples = spectrumCalc.getDroppedSamplesCount();
+
+    const int statistics_channels = std::min(statisticsCalc.getChannelsCount(), static_cast<int>(TelemetrySnapshot::max_channels));
+    for (int channel = 0; channel < statistics_channels; ++channel) {
+        TelemetrySnapshot::ChannelMetrics& metrics = snapshot.channels[static_cast<size_t>(channel)];
+        metrics.rms = statisticsCalc.getChannelRms(channel);
+        metrics.peak = statisticsCalc.getChannelPeak(channel);
+        metrics.dc_offset = statisticsCalc.getChannelDcOffset(channel);
+        metrics.crossing_rate = statisticsCalc.getChannelCrossingRate(channel);
+    }
+    const int lufs_channels = std::min(lufsCalc.getChannelsCount(), static_cast<int>(TelemetrySnapshot::max_channels));
+    for (int channel = 0; channel < lufs_channels; ++channel) {
+        TelemetrySnapshot::ChannelMetrics& metrics = snapshot.channels[static_cast<size_t>(channel)];
+        metrics.momentary_loudness = lufsCalc.getChannelMomentaryLoudness(channel);
+        metrics.short_term_loudness = lufsCalc.getChannelShortTermLoudness(channel);
+    }
+    const int true_peak_channels = std::min(truePeakCalc.getChannelsCount(), static_cast<int>(TelemetrySnapshot::max_channels));
+    for (int channel = 0; channel < true_peak_channels; ++channel) {
+        snapshot.channels[static_cast<size_t>(channel)].true_peak = truePeakCalc.getChannelTruePeak(channel);
+    }
+
+    telemetry.publish(snapshot);
+}
+
+LoudnessHistoryFifo& AudioStatisticsPluginAudioProcessor::getLoudnessHistory()
+{
+    return loudnessHistory;
+}
+
+int AudioStatisticsPluginAudioProcessor::getEditorRefreshRate() const
+{
+    return editor_refresh_rate_hz;
+}
+
+void AudioStatisticsPluginAudioProcessor::setEditorRefreshRate(int refreshRateHz)
+{
+    editor_refresh_rate_hz = refreshRateHz;
+}
+
+int AudioStatisticsPluginAudioProcessor::getLoudnessUpdateInterval() const
+{
+    return lufsCalc.getUpdateInterval() * 10;
+}
+
+void AudioStatisticsPluginAudioProcessor::setLoudnessUpdateInterval(int intervalMs)
+{
+    // Sub bins are 10ms long, interval has to divide 100ms bin
+    for (int allowed_interval : { 10, 20, 50, 100 }) {
+        if (intervalMs == allowed_interval) {
+            lufsCalc.setUpdateInterval(intervalMs / 10);
+            return;
+        }
+    }
+    jassertfalse;
 }
 
 //==============================================================================
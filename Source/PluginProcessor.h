@@ -10,6 +10,10 @@
 
 #include <JuceHeader.h>
 #include "Calculations/LUFS/LufsCalculations.h"
+#include "Calculations/Statistics/StatisticsCalculations.h"
+#include "Calculations/TruePeak/TruePeakCalculations.h"
+#include "Calculations/Spectrum/SpectrumCalculations.h"
+#include "Telemetry/TelemetryPublisher.h"
 
 //==============================================================================
 /**
@@ -33,6 +37,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -57,47 +63,74 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    // Audio thread only (or while audio thread is not running) - other threads use requestClearCounters
     void clearCounters();
 
-private:
-    // bin: 100ms - length container
-    // segment: 400ms - length container, that passed two gates-checks
-    //unsigned int bin_length_in_samples; // length of single bin
-    //std::vector<float> bin_rms_container; // Sum of squares of samples in each bin
-
-    //std::vector<float> segment_square_sums; // Sum of squares of samples in each segment
-
-    ////std::vector<float> bin_sums; // Sum of samples in each bin
-    //unsigned int current_position_in_filling_bin = 0; // Position in bin for filling it.
-    //
-
-    //unsigned short int bins_in_400ms = 4; // Number of bins that form Momentary Loudness
-    //unsigned short int bins_in_3s = 30; // Number of bins that form Short Term Loudness
-    //unsigned long long int processed_bin_counter = bins_in_400ms-1; // counter of already processed bins. Processing starts at bin bins_in_400ms (value 4), so default is bins_in_400ms-1 (value 3)
-    
-    LufsCalculations lufsCalc;
+    // Counters are cleared by the audio thread at the start of the next block, so it stays the only writer of all statistics
+    void requestClearCounters();
 
-    // Accumulators for calculating relative_thresholds
-    //float relative_threshold_acumulator = 0.0;
-    //unsigned long int relative_threshold_segments_count = 0;
+    // Latest values of all statistics, published once per block. Lock free, any thread.
+    const TelemetryPublisher& getTelemetry() const;
 
-    //std::atomic<float>* last_momentary_loudness = nullptr;
-    //std::atomic<float>* integrated_loudness = nullptr;
-    //std::atomic<float>* short_term_loudness = nullptr;
+    // Loudness of every 100ms bin, drained by the editor
+    LoudnessHistoryFifo& getLoudnessHistory();
 
-    std::atomic<float>* zero_passes = nullptr;
-    std::atomic<float>* rms = nullptr;
-    std::atomic<float>* min = nullptr;
-    std::atomic<float>* max = nullptr;
+    // Editor setting, kept here so that it survives closing the editor
+    int getEditorRefreshRate() const;
+    void setEditorRefreshRate(int refreshRateHz);
 
-    std::unique_ptr<float[]> previous_samples = nullptr;
-    std::unique_ptr<unsigned int> previous_length = nullptr;
-
-    std::unique_ptr<long long unsigned int[]> samples_count_per_channel = nullptr;
-    std::unique_ptr<float[]> square_sum_per_channel = nullptr;
+    // How often momentary and short term loudness are updated: 10, 20, 50 or 100 ms
+    int getLoudnessUpdateInterval() const;
+    void setLoudnessUpdateInterval(int intervalMs);
 
+private:
     juce::AudioProcessorValueTreeState valueTreeState;
 
+    StatisticsCalculations statisticsCalc;
+    LufsCalculations lufsCalc;
+    TruePeakCalculations truePeakCalc;
+    SpectrumCalculations spectrumCalc; // Not a part of measurement state - spectrum shows only the last frame
+
+    LoudnessHistoryFifo loudnessHistory;
+
+    // Body of both processBlock overloads - every calculation measures blocks in their native precision
+    template <typename SampleType>
+    void processBuffer(juce::AudioBuffer<SampleType>& buffer);
+
+    // Copies calculated values to telemetry_snapshot and publishes it, audio thread only
+    void publishTelemetry(int samplesNum);
+
+    // Measurement state is written and read only by the audio thread (or while it is not running - under the callback lock),
+    // the message thread only copies finished blobs under measurement_state_lock. Audio thread never waits for the lock,
+    // if it is taken the request is handled in the next block.
+    void saveMeasurementState();
+    void restoreMeasurementState();
+    size_t getMaxMeasurementStateSize() const;
+
+    // Audio thread copy of the published snapshot - preallocated, so that publishing doesn't allocate
+    TelemetrySnapshot telemetry_snapshot;
+    TelemetryPublisher telemetry;
+    std::atomic<bool> clear_counters_requested;
+
+    // State format: magic, version, editor refresh rate, loudness update interval (from version 2), size of measurement state, measurement state.
+    // Version has to be increased every time anything written by writeState methods changes (3 - statistics accumulators in double,
+    // 4 - per channel statistics, 5 - LUFS bins in double, 6 - K-weighting filter states in double).
+    static constexpr int state_magic = 0x53505341; // "ASPS"
+    static constexpr int state_version = 6;
+    static constexpr int state_save_timeout_ms = 100;
+    static constexpr double state_checkpoint_interval_seconds = 10.0;
+
+    juce::SpinLock measurement_state_lock;
+    juce::MemoryBlock saved_measurement_state; // Preallocated in prepareToPlay
+    size_t saved_measurement_state_size;
+    juce::MemoryBlock restored_measurement_state;
+    std::atomic<bool> save_state_requested;
+    juce::WaitableEvent state_saved; // Signalled by the audio thread when it saved state requested by getStateInformation
+    std::atomic<bool> restore_state_requested;
+    unsigned long long int samples_since_state_saved;
+
+    int editor_refresh_rate_hz;
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioStatisticsPluginAudioProcessor)
 };
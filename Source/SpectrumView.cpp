@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    SpectrumView.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumView.h"
+
+SpectrumView::SpectrumView() :
+    spectrum(),
+    dropped_samples_count(0)
+{
+    setOpaque(true);
+}
+
+void SpectrumView::setSpectrum(const SpectrumResult& newSpectrum, unsigned long long int droppedSamplesCount)
+{
+    // Frames count starts over after a reset, sequence number never repeats
+    if (newSpectrum.sequence_number == spectrum.sequence_number && droppedSamplesCount == dropped_samples_count) {
+        return;
+    }
+
+    spectrum = newSpectrum;
+    dropped_samples_count = droppedSamplesCount;
+    repaint();
+}
+
+void SpectrumView::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+    g.setFont(10.0f);
+
+    const int text_height = 12;
+    const float bars_height = static_cast<float>(getHeight() - 2 * text_height);
+    const float bar_width = static_cast<float>(getWidth()) / SpectrumResult::bands_count;
+
+    g.setColour(juce::Colours::orange);
+    for (int band = 0; band < SpectrumResult::bands_count; band++) {
+        const float height = levelToHeight(spectrum.band_rms[band]) * bars_height;
+        g.fillRect(band * bar_width + 1.0f, text_height + bars_height - height, bar_width - 2.0f, height);
+    }
+
+    // Frequency of every third band (octave)
+    g.setColour(juce::Colours::grey);
+    for (int band = 2; band < SpectrumResult::bands_count; band += 3) {
+        const double frequency = SpectrumResult::getBandCentreFrequency(band);
+        const juce::String label = frequency < 1000.0 ? juce::String(juce::roundToInt(frequency)) : juce::String(juce::roundToInt(frequency / 1000.0)) + "k";
+        g.drawText(label, juce::roundToInt((band - 1) * bar_width), getHeight() - text_height, juce::roundToInt(3 * bar_width), text_height, juce::Justification::centred);
+    }
+
+    g.setColour(juce::Colours::white);
+    g.drawText("Centroid: " + juce::String(juce::roundToInt(spectrum.centroid)) + " Hz   Flatness: " + juce::String(spectrum.flatness, 3),
+               2, 0, getWidth() - 4, text_height, juce::Justification::left);
+
+    // Worker didn't keep up - spectrum skips over part of the signal
+    if (dropped_samples_count > 0) {
+        g.setColour(juce::Colours::red);
+        g.drawText("Dropped samples: " + juce::String(static_cast<juce::int64>(dropped_samples_count)),
+                   2, 0, getWidth() - 4, text_height, juce::Justification::right);
+    }
+}
+
+float SpectrumView::levelToHeight(double rms) const
+{
+    // Silence and everything below lowest_level has no bar
+    const float level = rms > 0.0 ? static_cast<float>(20.0 * std::log10(rms)) : lowest_level;
+    return juce::jmap(juce::jlimit(lowest_level, highest_level, level), lowest_level, highest_level, 0.0f, 1.0f);
+}
@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    SpectrumView.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Calculations/Spectrum/SpectrumResult.h"
+
+// Third octave bands of the last analysed spectrum as bars, with spectral centroid and flatness.
+class SpectrumView : public juce::Component {
+public:
+    SpectrumView();
+
+    // Repaints only when a new result was published (or spectrum was reset), or more samples were dropped
+    void setSpectrum(const SpectrumResult& newSpectrum, unsigned long long int droppedSamplesCount);
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    float levelToHeight(double rms) const;
+
+    SpectrumResult spectrum;
+    unsigned long long int dropped_samples_count;
+
+    static constexpr float lowest_level = -90.0f; // dBFS
+    static constexpr float highest_level = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumView)
+};
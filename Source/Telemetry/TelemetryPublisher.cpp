@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    TelemetryPublisher.cpp
+
+  ==============================================================================
+*/
+
+// sources:
+//https://www.hpl.hp.com/techreports/2012/HPL-2012-68.pdf (Boehm - Can seqlocks get along with programming language memory models?)
+
+#include "TelemetryPublisher.h"
+
+static_assert(std::is_trivially_copyable<TelemetrySnapshot>::value, "TelemetrySnapshot is copied as raw words");
+
+TelemetryPublisher::TelemetryPublisher() :
+    sequence(0)
+{
+    publish(TelemetrySnapshot());
+}
+
+void TelemetryPublisher::publish(const TelemetrySnapshot& snapshot)
+{
+    juce::uint64 buffer[words_count] = {};
+    std::memcpy(buffer, &snapshot, sizeof(TelemetrySnapshot));
+
+    const unsigned long long int start = sequence.load(std::memory_order_relaxed);
+    sequence.store(start + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < words_count; i++) {
+        words[i].store(buffer[i], std::memory_order_relaxed);
+    }
+
+    sequence.store(start + 2, std::memory_order_release);
+}
+
+unsigned long long int TelemetryPublisher::read(TelemetrySnapshot& snapshot) const
+{
+    juce::uint64 buffer[words_count];
+    unsigned long long int start, end;
+
+    do {
+        start = sequence.load(std::memory_order_acquire);
+
+        for (size_t i = 0; i < words_count; i++) {
+            buffer[i] = words[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        end = sequence.load(std::memory_order_relaxed);
+    } while ((start & 1) != 0 || start != end);
+
+    std::memcpy(&snapshot, buffer, sizeof(TelemetrySnapshot));
+    return start / 2;
+}
+
+unsigned long long int TelemetryPublisher::getVersion() const
+{
+    return sequence.load(std::memory_order_acquire) / 2;
+}
@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    TelemetryPublisher.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TelemetrySnapshot.h"
+
+// Seqlock around TelemetrySnapshot. One writer (audio thread) publishes without ever waiting,
+// any number of readers copy the latest snapshot without locks - a reader only retries if the writer was publishing meanwhile.
+// Snapshot is stored as atomic 64 bit words, so concurrent copy is not a data race.
+class TelemetryPublisher {
+public:
+    TelemetryPublisher();
+
+    // Writer only
+    void publish(const TelemetrySnapshot& snapshot);
+
+    // Any thread. Returns version of the copied snapshot.
+    unsigned long long int read(TelemetrySnapshot& snapshot) const;
+
+    // Any thread. Changes with every published snapshot.
+    unsigned long long int getVersion() const;
+
+private:
+    static constexpr size_t words_count = (sizeof(TelemetrySnapshot) + sizeof(juce::uint64) - 1) / sizeof(juce::uint64);
+
+    std::atomic<unsigned long long int> sequence; // Odd while the writer is copying
+    std::array<std::atomic<juce::uint64>, words_count> words;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TelemetryPublisher)
+};
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    TelemetrySnapshot.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Calculations/Spectrum/SpectrumResult.h"
+
+// Everything the audio thread measured, published once per block as a single consistent snapshot,
+// so a reader never mixes values of different blocks. Plain values only - it is copied word by word by TelemetryPublisher.
+struct TelemetrySnapshot {
+    static constexpr int max_channels = 32; // Per channel values are kept for the first max_channels channels
+
+    unsigned long long int blocks_count = 0; // Blocks processed since the last reset
+    unsigned long long int samples_count = 0; // Samples of a single channel processed since the last reset
+    double sample_rate = 0.0;
+    int channels_count = 0;
+
+    // Statistics
+    unsigned long long int zero_passes = 0;
+    double rms = 0.0; // Mean of channel RMS values
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    // Loudness (LUFS, LU)
+    double momentary_loudness = -std::numeric_limits<double>::infinity();
+    double short_term_loudness = -std::numeric_limits<double>::infinity();
+    double integrated_loudness = -std::numeric_limits<double>::infinity();
+    double loudness_range = 0.0;
+    double max_momentary_loudness = -std::numeric_limits<double>::infinity();
+    double max_short_term_loudness = -std::numeric_limits<double>::infinity();
+
+    // dBTP
+    double true_peak = -std::numeric_limits<double>::infinity();
+
+    // Per channel values - one compact array instead of a parameter per value, so that many channels don't bloat the parameter list
+    struct ChannelMetrics {
+        double rms = 0.0;
+        double peak = 0.0; // Sample peak, linear
+        double dc_offset = 0.0; // Mean of samples
+        double crossing_rate = 0.0; // Zero passes per second
+        double momentary_loudness = -std::numeric_limits<double>::infinity(); // Channel on its own, without channel weight
+        double short_term_loudness = -std::numeric_limits<double>::infinity();
+        double true_peak = -std::numeric_limits<double>::infinity(); // dBTP
+    };
+
+    std::array<ChannelMetrics, max_channels> channels {};
+
+    // Spectrum of the mono downmix, from the last frame analysed by the spectrum worker
+    SpectrumResult spectrum;
+    unsigned long long int spectrum_dropped_samples = 0; // Samples the spectrum worker didn't keep up with since the last reset
+};
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    BatchAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "BatchAnalyzer.h"
+
+static juce::var finiteOrNull(double value)
+{
+    // -inf (silence) is not valid JSON
+    return std::isfinite(value) ? juce::var(value) : juce::var();
+}
+
+BatchAnalyzer::BatchAnalyzer(int threadsCount, int blockSize, OutputFormat outputFormat, std::ostream& output) :
+    threads_count(threadsCount),
+    block_size(blockSize),
+    output_format(outputFormat),
+    output(output),
+    analyzed_audio_seconds(0.0),
+    failed_files_count(0)
+{
+}
+
+int BatchAnalyzer::analyze(const juce::Array<juce::File>& files)
+{
+    // Longest files first (file size is a good enough estimate of length and doesn't need opening the file)
+    juce::Array<juce::File> queue(files);
+    std::sort(queue.begin(), queue.end(), [](const juce::File& a, const juce::File& b) {
+        return a.getSize() > b.getSize();
+    });
+
+    writeHeader();
+
+    const double start_time = juce::Time::getMillisecondCounterHiRes();
+
+    {
+        juce::ThreadPool pool(threads_count);
+        juce::WaitableEvent all_done;
+        std::atomic<int> files_left(queue.size());
+
+        for (const auto& file : queue) {
+            pool.addJob([this, file, &files_left, &all_done]() {
+                // Each file has its own calculations, memory per file is bounded by the block size
+                FileAnalyzer analyzer(block_size);
+                AnalysisResult result;
+                juce::String error;
+
+                analyzer.analyze(file, result, error);
+                writeResult(file, result, error);
+
+                if (--files_left == 0) {
+                    all_done.signal();
+                }
+            });
+        }
+
+        if (!queue.isEmpty()) {
+            all_done.wait();
+        }
+    }
+
+    const double wall_minutes = (juce::Time::getMillisecondCounterHiRes() - start_time) / 60000.0;
+
+    std::cerr << queue.size() << " files, " << juce::String(analyzed_audio_seconds / 3600.0, 2) << " audio hours in "
+              << juce::String(wall_minutes, 2) << " min: " << juce::String(analyzed_audio_seconds / 3600.0 / wall_minutes, 2)
+              << " audio hours per minute on " << threads_count << " threads" << std::endl;
+
+    return failed_files_count;
+}
+
+void BatchAnalyzer::writeHeader()
+{
+    if (output_format == OutputFormat::csv) {
+        output << "file,channels,sample_rate,duration_s,integrated_lufs,max_short_term_lufs,max_momentary_lufs,"
+                  "loudness_range_lu,sample_peak_dbfs,true_peak_dbtp,analysis_s,error" << std::endl;
+    }
+}
+
+void BatchAnalyzer::writeResult(const juce::File& file, const AnalysisResult& result, const juce::String& error)
+{
+    juce::String line;
+
+    if (output_format == OutputFormat::csv) {
+        juce::StringArray fields;
+        fields.add(file.getFullPathName().quoted());
+        fields.add(juce::String(result.channels_count));
+        fields.add(juce::String(result.sample_rate));
+        fields.add(juce::String(result.duration_seconds, 3));
+        fields.add(juce::String(result.integrated_loudness, 2));
+        fields.add(juce::String(result.max_short_term_loudness, 2));
+        fields.add(juce::String(result.max_momentary_loudness, 2));
+        fields.add(juce::String(result.loudness_range, 2));
+        fields.add(juce::String(result.sample_peak, 2));
+        fields.add(juce::String(result.true_peak, 2));
+        fields.add(juce::String(result.analysis_seconds, 3));
+        fields.add(error.quoted());
+        line = fields.joinIntoString(",");
+    }
+    else {
+        juce::DynamicObject::Ptr object(new juce::DynamicObject());
+        object->setProperty("file", file.getFullPathName());
+        object->setProperty("channels", result.channels_count);
+        object->setProperty("sample_rate", result.sample_rate);
+        object->setProperty("duration_s", result.duration_seconds);
+        object->setProperty("integrated_lufs", finiteOrNull(result.integrated_loudness));
+        object->setProperty("max_short_term_lufs", finiteOrNull(result.max_short_term_loudness));
+        object->setProperty("max_momentary_lufs", finiteOrNull(result.max_momentary_loudness));
+        object->setProperty("loudness_range_lu", finiteOrNull(result.loudness_range));
+        object->setProperty("sample_peak_dbfs", finiteOrNull(result.sample_peak));
+        object->setProperty("true_peak_dbtp", finiteOrNull(result.true_peak));
+        object->setProperty("analysis_s", result.analysis_seconds);
+        if (error.isNotEmpty()) {
+            object->setProperty("error", error);
+        }
+        line = juce::JSON::toString(juce::var(object.get()), true);
+    }
+
+    const juce::ScopedLock lock(output_lock);
+    output << line << std::endl;
+
+    if (error.isEmpty()) {
+        analyzed_audio_seconds += result.duration_seconds;
+    }
+    else {
+        failed_files_count++;
+    }
+}
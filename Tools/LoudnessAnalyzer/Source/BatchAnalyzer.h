@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    BatchAnalyzer.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "FileAnalyzer.h"
+
+// Analyzes many files in parallel - one independent FileAnalyzer per file.
+// Files are queued longest first, idle worker threads take the next file from the shared queue,
+// so a few long files started early don't leave the other cores without work at the end.
+// Every result is written (CSV or JSON lines) as soon as its file is finished.
+class BatchAnalyzer {
+public:
+    enum class OutputFormat { csv, json };
+
+    BatchAnalyzer(int threadsCount, int blockSize, OutputFormat outputFormat, std::ostream& output);
+
+    // Returns number of files that couldn't be analyzed
+    int analyze(const juce::Array<juce::File>& files);
+
+private:
+    void writeHeader();
+    void writeResult(const juce::File& file, const AnalysisResult& result, const juce::String& error);
+
+    int threads_count;
+    int block_size;
+    OutputFormat output_format;
+    std::ostream& output;
+
+    juce::CriticalSection output_lock;
+
+    // Totals for throughput report, guarded by output_lock
+    double analyzed_audio_seconds;
+    int failed_files_count;
+};
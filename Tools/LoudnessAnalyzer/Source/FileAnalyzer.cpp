@@ -0,0 +1,273 @@
+/*
+  ==============================================================================
+
+    FileAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "FileAnalyzer.h"
+
+FileAnalyzer::FileAnalyzer(int blockSize) :
+    formatManager(),
+    block_size(blockSize),
+    statisticsCalc(),
+    lufsCalc(),
+    truePeakCalc(),
+    channel_types(),
+    block()
+{
+    // WAV, AIFF, FLAC, Ogg (and MP3/CoreAudio where JUCE has them)
+    formatManager.registerBasicFormats();
+
+    statisticsCalc.zero_passes = &zero_passes;
+    statisticsCalc.rms = &rms;
+    statisticsCalc.min = &min;
+    statisticsCalc.max = &max;
+    lufsCalc.last_momentary_loudness = &momentary_loudness;
+    lufsCalc.integrated_loudness = &integrated_loudness;
+    lufsCalc.short_term_loudness = &short_term_loudness;
+    lufsCalc.loudness_range = &loudness_range;
+    truePeakCalc.true_peak = &true_peak;
+}
+
+bool FileAnalyzer::analyze(const juce::File& file, AnalysisResult& result, juce::String& error)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader = openFile(file, error);
+    if (reader == nullptr) {
+        return false;
+    }
+
+    const double start_time = juce::Time::getMillisecondCounterHiRes();
+
+    prepare(*reader);
+    if (!processRange(*reader, 0, reader->lengthInSamples, true, error)) {
+        return false;
+    }
+
+    fillResult(file, reader->sampleRate, static_cast<int>(reader->numChannels), reader->lengthInSamples, result);
+    result.analysis_seconds = (juce::Time::getMillisecondCounterHiRes() - start_time) / 1000.0;
+
+    return true;
+}
+
+bool FileAnalyzer::analyzeInChunks(const juce::File& file, int threadsCount, AnalysisResult& result, juce::String& error)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader = openFile(file, error);
+    if (reader == nullptr) {
+        return false;
+    }
+
+    const double start_time = juce::Time::getMillisecondCounterHiRes();
+
+    prepare(*reader);
+
+    // Chunks start at bin boundaries and are at least 4 times longer than their pre roll.
+    // There are more chunks than threads, so that threads finish at similar time.
+    const juce::int64 bin_length = lufsCalc.getBinLengthInSamples();
+    const juce::int64 bins_count = reader->lengthInSamples / bin_length;
+    const juce::int64 chunks_count = juce::jlimit(static_cast<juce::int64>(1), static_cast<juce::int64>(threadsCount) * 2,
+                                                  bins_count / static_cast<juce::int64>(pre_roll_bins_count * 4));
+    const juce::int64 chunk_length = ((bins_count + chunks_count - 1) / chunks_count) * bin_length;
+
+    std::vector<LufsPartialResult> lufs_results(static_cast<size_t>(chunks_count));
+    std::vector<StatisticsPartialResult> statistics_results(static_cast<size_t>(chunks_count));
+    std::vector<double> true_peak_results(static_cast<size_t>(chunks_count), -std::numeric_limits<double>::infinity());
+    juce::StringArray errors;
+    juce::CriticalSection errors_lock;
+
+    {
+        juce::ThreadPool pool(threadsCount);
+        juce::WaitableEvent all_done;
+        std::atomic<juce::int64> chunks_left(chunks_count);
+
+        for (juce::int64 chunk = 0; chunk < chunks_count; ++chunk) {
+            pool.addJob([&, chunk]() {
+                const juce::int64 chunk_start = chunk * chunk_length;
+                const juce::int64 chunk_end = (chunk == chunks_count - 1) ? reader->lengthInSamples : chunk_start + chunk_length;
+                const juce::int64 pre_roll_start = std::max(static_cast<juce::int64>(0), chunk_start - static_cast<juce::int64>(pre_roll_bins_count) * bin_length);
+
+                // Reader is not thread safe, every chunk reads file on its own
+                FileAnalyzer chunk_analyzer(block_size);
+                juce::String chunk_error;
+                std::unique_ptr<juce::AudioFormatReader> chunk_reader = chunk_analyzer.openFile(file, chunk_error);
+
+                bool succeeded = chunk_reader != nullptr;
+
+                if (succeeded) {
+                    chunk_analyzer.prepare(*chunk_reader);
+                    chunk_analyzer.lufsCalc.setPreRoll(static_cast<unsigned long long int>((chunk_start - pre_roll_start) / bin_length));
+
+                    succeeded = chunk_analyzer.processRange(*chunk_reader, pre_roll_start, chunk_start, false, chunk_error);
+
+                    // True peak needs pre roll only as history of the interpolator
+                    chunk_analyzer.truePeakCalc.clearCounters();
+
+                    succeeded = succeeded && chunk_analyzer.processRange(*chunk_reader, chunk_start, chunk_end, true, chunk_error);
+                }
+
+                if (succeeded) {
+                    lufs_results[static_cast<size_t>(chunk)] = chunk_analyzer.lufsCalc.getPartialResult();
+                    statistics_results[static_cast<size_t>(chunk)] = chunk_analyzer.statisticsCalc.getPartialResult();
+                    true_peak_results[static_cast<size_t>(chunk)] = chunk_analyzer.truePeakCalc.getTruePeak();
+                }
+                else {
+                    const juce::ScopedLock lock(errors_lock);
+                    errors.add(chunk_error);
+                }
+
+                if (--chunks_left == 0) {
+                    all_done.signal();
+                }
+            });
+        }
+
+        all_done.wait();
+    }
+
+    if (!errors.isEmpty()) {
+        error = errors[0];
+        return false;
+    }
+
+    // Statistics have to be merged in file order (zero passes on chunk boundaries), others don't care
+    double merged_true_peak = -std::numeric_limits<double>::infinity();
+    for (juce::int64 chunk = 0; chunk < chunks_count; ++chunk) {
+        lufsCalc.mergePartialResult(lufs_results[static_cast<size_t>(chunk)]);
+        statisticsCalc.mergePartialResult(statistics_results[static_cast<size_t>(chunk)]);
+        merged_true_peak = std::max(merged_true_peak, true_peak_results[static_cast<size_t>(chunk)]);
+    }
+
+    fillResult(file, reader->sampleRate, static_cast<int>(reader->numChannels), reader->lengthInSamples, result);
+    result.true_peak = merged_true_peak;
+    result.analysis_seconds = (juce::Time::getMillisecondCounterHiRes() - start_time) / 1000.0;
+
+    return true;
+}
+
+bool FileAnalyzer::analyzeMapped(const juce::File& file, AnalysisResult& result, juce::String& error)
+{
+    MappedWavFile wav;
+    if (!wav.open(file, error)) {
+        return false;
+    }
+
+    const double start_time = juce::Time::getMillisecondCounterHiRes();
+
+    const int channels_count = wav.getChannelsCount();
+
+    statisticsCalc.prepareToPlay(wav.getSampleRate(), block_size, channels_count);
+    lufsCalc.prepareToPlay(wav.getSampleRate(), block_size, wav.getChannelTypes());
+    truePeakCalc.prepareToPlay(wav.getSampleRate(), block_size, channels_count);
+
+    statisticsCalc.clearCounters();
+    lufsCalc.clearCounters();
+    truePeakCalc.clearCounters();
+
+    block.setSize(channels_count, block_size);
+
+    wav.adviseSequentialAccess();
+    wav.prefetch(0, block_size);
+
+    for (juce::int64 position = 0; position < wav.getLengthInSamples(); position += block_size) {
+        const int samplesNum = static_cast<int>(std::min(static_cast<juce::int64>(block_size), wav.getLengthInSamples() - position));
+
+        // Next block is read by the kernel while this one is measured
+        wav.prefetch(position + block_size, block_size);
+
+        block.setSize(channels_count, samplesNum, false, false, true);
+        wav.readFrames(position, samplesNum, block);
+
+        // Same order as in AudioStatisticsPluginAudioProcessor::processBlock
+        statisticsCalc.processBlock(block, channels_count);
+        lufsCalc.processInterleaved(wav.getFrames(position), samplesNum);
+        truePeakCalc.processBlock(block, channels_count);
+    }
+
+    fillResult(file, wav.getSampleRate(), channels_count, wav.getLengthInSamples(), result);
+    result.analysis_seconds = (juce::Time::getMillisecondCounterHiRes() - start_time) / 1000.0;
+
+    return true;
+}
+
+std::unique_ptr<juce::AudioFormatReader> FileAnalyzer::openFile(const juce::File& file, juce::String& error)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr) {
+        error = "Can't read " + file.getFullPathName();
+        return nullptr;
+    }
+
+    // Same speakers as analyzeMapped gives to the file, so that results don't depend on --mmap.
+    // Layouts that don't match the channel count fall back to the canonical layout on both paths.
+    const int channels_count = static_cast<int>(reader->numChannels);
+    if (reader->getFormatName() == "WAV file") {
+        channel_types = MappedWavFile::getChannelTypes(MappedWavFile::readChannelMask(file), channels_count);
+    }
+    else if (reader->getChannelLayout().size() == channels_count) {
+        channel_types = reader->getChannelLayout().getChannelTypes();
+    }
+    else {
+        channel_types = juce::AudioChannelSet::canonicalChannelSet(channels_count).getChannelTypes();
+    }
+
+    return reader;
+}
+
+void FileAnalyzer::prepare(const juce::AudioFormatReader& reader)
+{
+    const int channels_count = static_cast<int>(reader.numChannels);
+
+    statisticsCalc.prepareToPlay(reader.sampleRate, block_size, channels_count);
+    lufsCalc.prepareToPlay(reader.sampleRate, block_size, channel_types);
+    truePeakCalc.prepareToPlay(reader.sampleRate, block_size, channels_count);
+
+    statisticsCalc.clearCounters();
+    lufsCalc.clearCounters();
+    truePeakCalc.clearCounters();
+
+    block.setSize(channels_count, block_size);
+}
+
+bool FileAnalyzer::processRange(juce::AudioFormatReader& reader, juce::int64 start, juce::int64 end, bool withStatistics, juce::String& error)
+{
+    const int channels_count = static_cast<int>(reader.numChannels);
+
+    for (juce::int64 position = start; position < end; position += block_size) {
+        const int samplesNum = static_cast<int>(std::min(static_cast<juce::int64>(block_size), end - position));
+        block.setSize(channels_count, samplesNum, false, false, true);
+
+        if (!reader.read(&block, 0, samplesNum, position, true, true)) {
+            error = "Read error at sample " + juce::String(position);
+            return false;
+        }
+
+        // Same order as in AudioStatisticsPluginAudioProcessor::processBlock
+        if (withStatistics) {
+            statisticsCalc.processBlock(block, channels_count);
+        }
+        lufsCalc.processBlock(block, channels_count);
+        truePeakCalc.processBlock(block, channels_count);
+    }
+
+    return true;
+}
+
+void FileAnalyzer::fillResult(const juce::File& file, double sampleRate, int channelsCount, juce::int64 lengthInSamples, AnalysisResult& result)
+{
+    result.file_name = file.getFileName();
+    result.sample_rate = sampleRate;
+    result.channels_count = channelsCount;
+    result.duration_seconds = lengthInSamples / sampleRate;
+
+    // Full precision getters - parameters published for the plugin are only floats
+    result.integrated_loudness = lufsCalc.getIntegratedLoudness();
+    result.max_short_term_loudness = lufsCalc.getMaxShortTermLoudness();
+    result.max_momentary_loudness = lufsCalc.getMaxMomentaryLoudness();
+    result.loudness_range = lufsCalc.getLoudnessRange();
+
+    result.sample_peak = juce::Decibels::gainToDecibels(std::max(-statisticsCalc.getMin(), statisticsCalc.getMax()), -std::numeric_limits<double>::infinity());
+    result.true_peak = truePeakCalc.getTruePeak();
+    result.rms = statisticsCalc.getRms();
+    result.zero_passes = statisticsCalc.getZeroPassesCount();
+}
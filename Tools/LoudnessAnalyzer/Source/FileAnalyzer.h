@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    FileAnalyzer.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/Calculations/Statistics/StatisticsCalculations.h"
+#include "../../../Source/Calculations/LUFS/LufsCalculations.h"
+#include "../../../Source/Calculations/TruePeak/TruePeakCalculations.h"
+#include "MappedWavFile.h"
+
+struct AnalysisResult {
+    juce::String file_name;
+    double sample_rate = 0.0;
+    int channels_count = 0;
+    double duration_seconds = 0.0;
+
+    double integrated_loudness = 0.0;
+    double max_short_term_loudness = 0.0;
+    double max_momentary_loudness = 0.0;
+    double loudness_range = 0.0;
+
+    double sample_peak = 0.0; // dBFS
+    double true_peak = 0.0; // dBTP
+    double rms = 0.0;
+    unsigned long long int zero_passes = 0;
+
+    double analysis_seconds = 0.0; // wall clock time of the analysis
+};
+
+// Runs the same calculations as the plugin over a whole audio file, streamed in big blocks.
+class FileAnalyzer {
+public:
+    FileAnalyzer(int blockSize = 65536);
+
+    bool analyze(const juce::File& file, AnalysisResult& result, juce::String& error);
+
+    // Splits one long file into chunks measured concurrently on threadsCount threads, and merges their partial results.
+    // Each chunk starts with a pre roll, that only warms up filters, so results are the same as from analyze().
+    bool analyzeInChunks(const juce::File& file, int threadsCount, AnalysisResult& result, juce::String& error);
+
+    // Uncompressed WAV/RF64 files read from memory mapped file instead of AudioFormatReader. LUFS filters read interleaved
+    // samples straight from the mapping, statistics and true peak get them converted to a float block.
+    bool analyzeMapped(const juce::File& file, AnalysisResult& result, juce::String& error);
+
+private:
+    // Also sets channel_types of the file
+    std::unique_ptr<juce::AudioFormatReader> openFile(const juce::File& file, juce::String& error);
+    void prepare(const juce::AudioFormatReader& reader);
+
+    // Feeds samples [start, end) of the file to calculations. Statistics are skipped in the pre roll of a chunk.
+    bool processRange(juce::AudioFormatReader& reader, juce::int64 start, juce::int64 end, bool withStatistics, juce::String& error);
+
+    void fillResult(const juce::File& file, double sampleRate, int channelsCount, juce::int64 lengthInSamples, AnalysisResult& result);
+
+    // 3s for short term blocks + 1s for K-weighting filters to settle
+    static constexpr unsigned long long int pre_roll_bins_count = LufsChannelBank::bins_in_3s + 10;
+
+    juce::AudioFormatManager formatManager;
+    int block_size;
+
+    // Values published by the calculations, like APVTS parameters in the plugin
+    std::atomic<float> zero_passes, rms, min, max;
+    std::atomic<float> momentary_loudness, integrated_loudness, short_term_loudness, loudness_range;
+    std::atomic<float> true_peak;
+
+    StatisticsCalculations statisticsCalc;
+    LufsCalculations lufsCalc;
+    TruePeakCalculations truePeakCalc;
+
+    // Speaker of every channel, in the order reader returns them. AudioChannelSet of the reader can't be used -
+    // it is sorted by channel type, while WAV channels are in channel mask bit order.
+    juce::Array<juce::AudioChannelSet::ChannelType> channel_types;
+
+    juce::AudioBuffer<float> block;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FileAnalyzer)
+};
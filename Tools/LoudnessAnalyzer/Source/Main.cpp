@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    Headless loudness analyzer - runs plugin calculations over audio files.
+
+    Usage: LoudnessAnalyzer [--block-size=N] [--mmap] [--chunks [--jobs=N]] file1.wav [file2.flac ...]
+           LoudnessAnalyzer --batch [--jobs=N] [--format=csv|json] [--output=results.csv] [--block-size=N] files or directories...
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <fstream>
+#include "FileAnalyzer.h"
+#include "BatchAnalyzer.h"
+
+static void printResult(const AnalysisResult& result)
+{
+    std::cout << result.file_name << " (" << result.channels_count << " ch, " << result.sample_rate << " Hz, "
+              << juce::String(result.duration_seconds, 1) << " s)" << std::endl;
+    std::cout << "  Integrated:       " << juce::String(result.integrated_loudness, 1) << " LUFS" << std::endl;
+    std::cout << "  Short term max:   " << juce::String(result.max_short_term_loudness, 1) << " LUFS" << std::endl;
+    std::cout << "  Momentary max:    " << juce::String(result.max_momentary_loudness, 1) << " LUFS" << std::endl;
+    std::cout << "  Loudness range:   " << juce::String(result.loudness_range, 1) << " LU" << std::endl;
+    std::cout << "  Sample peak:      " << juce::String(result.sample_peak, 1) << " dBFS" << std::endl;
+    std::cout << "  True peak:        " << juce::String(result.true_peak, 1) << " dBTP" << std::endl;
+    std::cout << "  Speed:            " << juce::String(result.duration_seconds / result.analysis_seconds, 0) << "x real time" << std::endl;
+}
+
+static juce::Array<juce::File> collectFiles(const juce::ArgumentList& arguments)
+{
+    // Directories are searched recursively for audio files
+    juce::Array<juce::File> files;
+    for (const auto& argument : arguments.arguments) {
+        juce::File file = argument.resolveAsFile();
+        if (file.isDirectory()) {
+            files.addArray(file.findChildFiles(juce::File::findFiles, true, "*.wav;*.wave;*.bwf;*.aif;*.aiff;*.flac;*.ogg"));
+        }
+        else {
+            files.add(file);
+        }
+    }
+    return files;
+}
+
+static int runBatch(juce::ArgumentList& arguments, int block_size, int threads_count)
+{
+    BatchAnalyzer::OutputFormat output_format = BatchAnalyzer::OutputFormat::csv;
+    if (arguments.containsOption("--format")) {
+        if (arguments.getValueForOption("--format") == "json") {
+            output_format = BatchAnalyzer::OutputFormat::json;
+        }
+        arguments.removeValueForOption("--format");
+    }
+
+    std::ofstream output_file;
+    if (arguments.containsOption("--output")) {
+        output_file.open(arguments.getValueForOption("--output").toStdString());
+        arguments.removeValueForOption("--output");
+        if (!output_file.is_open()) {
+            std::cerr << "Can't open output file" << std::endl;
+            return 1;
+        }
+    }
+
+    BatchAnalyzer batch(threads_count, block_size, output_format, output_file.is_open() ? output_file : std::cout);
+    return batch.analyze(collectFiles(arguments)) == 0 ? 0 : 1;
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList arguments(argc, argv);
+
+    if (arguments.size() == 0 || arguments.containsOption("--help|-h")) {
+        std::cout << "Usage: " << arguments.executableName << " [--block-size=N] [--mmap] [--chunks [--jobs=N]] file1.wav [file2.flac ...]" << std::endl;
+        std::cout << "       " << arguments.executableName << " --batch [--jobs=N] [--format=csv|json] [--output=results.csv] [--block-size=N] files or directories..." << std::endl;
+        return 0;
+    }
+
+    int block_size = 65536;
+    if (arguments.containsOption("--block-size")) {
+        block_size = juce::jmax(1, arguments.getValueForOption("--block-size").getIntValue());
+        arguments.removeValueForOption("--block-size");
+    }
+
+    int threads_count = juce::SystemStats::getNumCpus();
+    if (arguments.containsOption("--jobs")) {
+        threads_count = juce::jmax(1, arguments.getValueForOption("--jobs").getIntValue());
+        arguments.removeValueForOption("--jobs");
+    }
+
+    if (arguments.removeOptionIfFound("--batch")) {
+        return runBatch(arguments, block_size, threads_count);
+    }
+
+    // Every file is split into chunks analyzed on all threads - for single long recordings
+    const bool in_chunks = arguments.removeOptionIfFound("--chunks");
+
+    // Uncompressed WAV/RF64 read straight from memory mapped file, other files use the normal path
+    const bool memory_mapped = arguments.removeOptionIfFound("--mmap");
+
+    FileAnalyzer analyzer(block_size);
+    int failed_files = 0;
+
+    for (const auto& argument : arguments.arguments) {
+        AnalysisResult result;
+        juce::String error;
+
+        const juce::File file = argument.resolveAsFile();
+
+        bool succeeded = false;
+        if (memory_mapped) {
+            succeeded = analyzer.analyzeMapped(file, result, error);
+        }
+        if (!succeeded) {
+            succeeded = in_chunks ? analyzer.analyzeInChunks(file, threads_count, result, error)
+                                  : analyzer.analyze(file, result, error);
+        }
+        if (succeeded) {
+            printResult(result);
+        }
+        else {
+            std::cerr << error << std::endl;
+            failed_files++;
+        }
+    }
+
+    return failed_files == 0 ? 0 : 1;
+}
@@ -0,0 +1,303 @@
+/*
+  ==============================================================================
+
+    MappedWavFile.cpp
+
+  ==============================================================================
+*/
+
+// sources:
+//https://www.mmsp.ece.mcgill.ca/Documents/AudioFormats/WAVE/WAVE.html
+//https://tech.ebu.ch/docs/tech/tech3306.pdf (RF64)
+
+#include "MappedWavFile.h"
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #include <sys/mman.h>
+ #include <unistd.h>
+#endif
+
+MappedWavFile::MappedWavFile() :
+    mapped_file(),
+    sample_data(nullptr),
+    length_in_samples(0),
+    sample_rate(0.0),
+    channels_count(0),
+    bytes_per_frame(0),
+    sample_format(InterleavedPcm::SampleFormat::float32),
+    channel_mask(0)
+{
+}
+
+bool MappedWavFile::open(const juce::File& file, juce::String& error)
+{
+    mapped_file = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly, false);
+
+    const juce::uint8* file_data = static_cast<const juce::uint8*>(mapped_file->getData());
+    const juce::uint64 file_size = static_cast<juce::uint64>(mapped_file->getSize());
+    if (file_data == nullptr || file_size < 12) {
+        error = "Can't map " + file.getFullPathName();
+        return false;
+    }
+
+    const bool is_rf64 = memcmp(file_data, "RF64", 4) == 0 || memcmp(file_data, "BW64", 4) == 0;
+    if ((memcmp(file_data, "RIFF", 4) != 0 && !is_rf64) || memcmp(file_data + 8, "WAVE", 4) != 0) {
+        error = "Not a WAV file: " + file.getFullPathName();
+        return false;
+    }
+
+    // RF64 keeps 64 bit size of data chunk in ds64 chunk, 32 bit size of data chunk is 0xFFFFFFFF then
+    juce::uint64 ds64_data_size = 0;
+    bool has_format = false;
+
+    juce::uint64 position = 12;
+    while (position + 8 <= file_size) {
+        const juce::uint8* chunk = file_data + position;
+        juce::uint64 chunk_size = juce::ByteOrder::littleEndianInt(chunk + 4);
+        const juce::uint8* chunk_data = chunk + 8;
+
+        if (memcmp(chunk, "ds64", 4) == 0 && chunk_size >= 16) {
+            ds64_data_size = juce::ByteOrder::littleEndianInt64(chunk_data + 8);
+        }
+        else if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (!parseFormatChunk(chunk_data, std::min(chunk_size, file_size - position - 8), error)) {
+                error << ": " << file.getFullPathName();
+                return false;
+            }
+            has_format = true;
+        }
+        else if (memcmp(chunk, "data", 4) == 0) {
+            if (!has_format) {
+                error = "No fmt chunk before data: " + file.getFullPathName();
+                return false;
+            }
+
+            if (is_rf64 && chunk_size == 0xffffffff) {
+                chunk_size = ds64_data_size;
+            }
+
+            // Recording may have been interrupted - only frames that are really in the file are measured
+            chunk_size = std::min(chunk_size, file_size - position - 8);
+
+            sample_data = chunk_data;
+            length_in_samples = static_cast<juce::int64>(chunk_size / static_cast<juce::uint64>(bytes_per_frame));
+            return true;
+        }
+
+        // Chunks are padded to even size
+        position += 8 + chunk_size + (chunk_size & 1);
+    }
+
+    error = "No data chunk: " + file.getFullPathName();
+    return false;
+}
+
+bool MappedWavFile::parseFormatChunk(const juce::uint8* chunk, juce::uint64 chunk_size, juce::String& error)
+{
+    if (chunk_size < 16) {
+        error = "Broken fmt chunk";
+        return false;
+    }
+
+    juce::uint16 format_tag = juce::ByteOrder::littleEndianShort(chunk);
+    channels_count = juce::ByteOrder::littleEndianShort(chunk + 2);
+    sample_rate = juce::ByteOrder::littleEndianInt(chunk + 4);
+    bytes_per_frame = juce::ByteOrder::littleEndianShort(chunk + 12);
+    const int bits_per_sample = juce::ByteOrder::littleEndianShort(chunk + 14);
+
+    // WAVE_FORMAT_EXTENSIBLE - real format is in first two bytes of sub format GUID
+    if (format_tag == 0xfffe && chunk_size >= 40) {
+        channel_mask = juce::ByteOrder::littleEndianInt(chunk + 20);
+        format_tag = juce::ByteOrder::littleEndianShort(chunk + 24);
+    }
+
+    if (channels_count <= 0 || sample_rate <= 0.0 || bytes_per_frame != channels_count * bits_per_sample / 8) {
+        error = "Broken fmt chunk";
+        return false;
+    }
+
+    if (format_tag == 1 && bits_per_sample == 16) {
+        sample_format = InterleavedPcm::SampleFormat::int16;
+    }
+    else if (format_tag == 1 && bits_per_sample == 24) {
+        sample_format = InterleavedPcm::SampleFormat::int24;
+    }
+    else if (format_tag == 3 && bits_per_sample == 32) {
+        sample_format = InterleavedPcm::SampleFormat::float32;
+    }
+    else {
+        error = "Unsupported sample format (" + juce::String(bits_per_sample) + " bit, format " + juce::String(format_tag) + ")";
+        return false;
+    }
+
+    return true;
+}
+
+double MappedWavFile::getSampleRate() const
+{
+    return sample_rate;
+}
+
+int MappedWavFile::getChannelsCount() const
+{
+    return channels_count;
+}
+
+juce::int64 MappedWavFile::getLengthInSamples() const
+{
+    return length_in_samples;
+}
+
+juce::Array<juce::AudioChannelSet::ChannelType> MappedWavFile::getChannelTypes() const
+{
+    return getChannelTypes(channel_mask, channels_count);
+}
+
+juce::Array<juce::AudioChannelSet::ChannelType> MappedWavFile::getChannelTypes(juce::uint32 channelMask, int channelsCount)
+{
+    // Speaker positions of WAV channel mask bits, in bit order (as in JUCE WavAudioFormat)
+    static const juce::AudioChannelSet::ChannelType mask_channel_types[] = {
+        juce::AudioChannelSet::left, juce::AudioChannelSet::right, juce::AudioChannelSet::centre, juce::AudioChannelSet::LFE,
+        juce::AudioChannelSet::leftSurroundRear, juce::AudioChannelSet::rightSurroundRear,
+        juce::AudioChannelSet::leftCentre, juce::AudioChannelSet::rightCentre, juce::AudioChannelSet::centreSurround,
+        juce::AudioChannelSet::leftSurroundSide, juce::AudioChannelSet::rightSurroundSide,
+        juce::AudioChannelSet::topMiddle, juce::AudioChannelSet::topFrontLeft, juce::AudioChannelSet::topFrontCentre,
+        juce::AudioChannelSet::topFrontRight, juce::AudioChannelSet::topRearLeft, juce::AudioChannelSet::topRearCentre,
+        juce::AudioChannelSet::topRearRight
+    };
+    constexpr int mask_bits_count = static_cast<int>(sizeof(mask_channel_types) / sizeof(mask_channel_types[0]));
+
+    const bool mask_is_known = channelMask != 0 && (channelMask >> mask_bits_count) == 0;
+    if (!mask_is_known || juce::BigInteger(static_cast<juce::int64>(channelMask)).countNumberOfSetBits() != channelsCount) {
+        return juce::AudioChannelSet::canonicalChannelSet(channelsCount).getChannelTypes();
+    }
+
+    // Without side channels (5.1 as 0x3F) the back pair is the surround pair, like leftSurround / rightSurround of host 5.1.
+    // With them (7.1 as 0x63F) it is the rear pair - weights are the same as the plugin gives to the same layout.
+    const bool has_side_channels = (channelMask & 0x600) != 0;
+
+    // Channels are interleaved in bit order, which is not the order of AudioChannelSet for rear channels
+    juce::Array<juce::AudioChannelSet::ChannelType> channel_types;
+    for (int bit = 0; bit < mask_bits_count; bit++) {
+        if ((channelMask >> bit) & 1) {
+            juce::AudioChannelSet::ChannelType type = mask_channel_types[bit];
+            if (!has_side_channels && type == juce::AudioChannelSet::leftSurroundRear) {
+                type = juce::AudioChannelSet::leftSurround;
+            }
+            else if (!has_side_channels && type == juce::AudioChannelSet::rightSurroundRear) {
+                type = juce::AudioChannelSet::rightSurround;
+            }
+            channel_types.add(type);
+        }
+    }
+    return channel_types;
+}
+
+juce::uint32 MappedWavFile::readChannelMask(const juce::File& file)
+{
+    juce::FileInputStream stream(file);
+    char id[4];
+    if (!stream.openedOk() || stream.read(id, 4) != 4 || (memcmp(id, "RIFF", 4) != 0 && memcmp(id, "RF64", 4) != 0 && memcmp(id, "BW64", 4) != 0)) {
+        return 0;
+    }
+
+    stream.skipNextBytes(4);
+    if (stream.read(id, 4) != 4 || memcmp(id, "WAVE", 4) != 0) {
+        return 0;
+    }
+
+    // fmt chunk is always before data chunk, chunks in between (bext, iXML...) are skipped
+    while (stream.read(id, 4) == 4 && memcmp(id, "data", 4) != 0) {
+        const juce::int64 chunk_size = static_cast<juce::uint32>(stream.readInt());
+        const juce::int64 chunk_start = stream.getPosition();
+
+        if (memcmp(id, "fmt ", 4) == 0) {
+            // WAVE_FORMAT_EXTENSIBLE - mask is at byte 20 of the chunk, as in parseFormatChunk
+            if (chunk_size < 40 || static_cast<juce::uint16>(stream.readShort()) != 0xfffe) {
+                return 0;
+            }
+            stream.skipNextBytes(18);
+            return static_cast<juce::uint32>(stream.readInt());
+        }
+
+        // Chunks are padded to even size
+        if (!stream.setPosition(chunk_start + chunk_size + (chunk_size & 1))) {
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+InterleavedPcm MappedWavFile::getFrames(juce::int64 start_frame) const
+{
+    jassert(start_frame <= length_in_samples);
+
+    InterleavedPcm pcm;
+    pcm.data = sample_data + start_frame * bytes_per_frame;
+    pcm.frame_channels = channels_count;
+    pcm.format = sample_format;
+    return pcm;
+}
+
+void MappedWavFile::readFrames(juce::int64 start_frame, int framesNum, juce::AudioBuffer<float>& buffer) const
+{
+    jassert(start_frame + framesNum <= length_in_samples);
+    jassert(buffer.getNumChannels() == channels_count && buffer.getNumSamples() >= framesNum);
+
+    // Samples are read byte by byte - data chunk is aligned to 2 bytes only
+    const int bytes_per_sample = bytes_per_frame / channels_count;
+    for (int channel = 0; channel < channels_count; channel++) {
+        float* samples = buffer.getWritePointer(channel);
+        const juce::uint8* source = sample_data + start_frame * bytes_per_frame + channel * bytes_per_sample;
+
+        switch (sample_format) {
+        case InterleavedPcm::SampleFormat::int16:
+            for (int i = 0; i < framesNum; i++, source += bytes_per_frame) {
+                samples[i] = static_cast<float>(static_cast<juce::int16>(juce::ByteOrder::littleEndianShort(source))) * (1.0f / 32768.0f);
+            }
+            break;
+        case InterleavedPcm::SampleFormat::int24:
+            for (int i = 0; i < framesNum; i++, source += bytes_per_frame) {
+                samples[i] = static_cast<float>(juce::ByteOrder::littleEndian24Bit(source)) * (1.0f / 8388608.0f);
+            }
+            break;
+        case InterleavedPcm::SampleFormat::float32:
+            for (int i = 0; i < framesNum; i++, source += bytes_per_frame) {
+                const juce::uint32 bits = juce::ByteOrder::littleEndianInt(source);
+                memcpy(&samples[i], &bits, sizeof(float));
+            }
+            break;
+        }
+    }
+}
+
+void MappedWavFile::adviseSequentialAccess()
+{
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+    // Kernel reads ahead more aggressively and may drop pages that were already read
+    madvise(const_cast<void*>(mapped_file->getData()), mapped_file->getSize(), MADV_SEQUENTIAL);
+#endif
+}
+
+void MappedWavFile::prefetch(juce::int64 start_frame, juce::int64 frames_count)
+{
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+    start_frame = std::min(start_frame, length_in_samples);
+    frames_count = std::min(frames_count, length_in_samples - start_frame);
+    if (frames_count <= 0) {
+        return;
+    }
+
+    // madvise needs page aligned address, mapping itself starts at the page boundary
+    const juce::uint8* file_data = static_cast<const juce::uint8*>(mapped_file->getData());
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t start = static_cast<size_t>(sample_data - file_data) + static_cast<size_t>(start_frame * bytes_per_frame);
+    const size_t aligned_start = start - start % page_size;
+    const size_t length = start + static_cast<size_t>(frames_count * bytes_per_frame) - aligned_start;
+
+    madvise(const_cast<juce::uint8*>(file_data) + aligned_start, length, MADV_WILLNEED);
+#else
+    juce::ignoreUnused(start_frame, frames_count);
+#endif
+}
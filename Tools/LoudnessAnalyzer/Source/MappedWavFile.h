@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    MappedWavFile.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/Calculations/LUFS/LufsChannelBank.h"
+
+// Uncompressed WAV / BWF / RF64 file mapped into memory. Samples are read straight from the page cache,
+// without decoding them into AudioBuffer. Only int16, int24 and float32 samples are supported,
+// anything else has to go through AudioFormatReader.
+class MappedWavFile {
+public:
+    MappedWavFile();
+
+    bool open(const juce::File& file, juce::String& error);
+
+    double getSampleRate() const;
+    int getChannelsCount() const;
+    juce::int64 getLengthInSamples() const;
+
+    // Speaker of every channel, in the order channels are interleaved in the file
+    juce::Array<juce::AudioChannelSet::ChannelType> getChannelTypes() const;
+
+    // Speakers of WAV channel mask bits, in the order channels are interleaved. Mask that doesn't describe channelsCount
+    // channels (or 0, file without mask) gives canonical layout of channelsCount channels.
+    static juce::Array<juce::AudioChannelSet::ChannelType> getChannelTypes(juce::uint32 channelMask, int channelsCount);
+
+    // Channel mask from fmt chunk of any WAV / RF64 file, also of sample formats that can't be mapped. 0 if there is none.
+    static juce::uint32 readChannelMask(const juce::File& file);
+
+    // Interleaved samples starting at frame start_frame
+    InterleavedPcm getFrames(juce::int64 start_frame) const;
+
+    // Converts framesNum frames starting at start_frame to float, for calculations that need planar blocks
+    void readFrames(juce::int64 start_frame, int framesNum, juce::AudioBuffer<float>& buffer) const;
+
+    // Hints for the kernel: whole file is read once from start to end, and frames in the range will be needed soon
+    void adviseSequentialAccess();
+    void prefetch(juce::int64 start_frame, juce::int64 frames_count);
+
+private:
+    bool parseFormatChunk(const juce::uint8* chunk, juce::uint64 chunk_size, juce::String& error);
+
+    std::unique_ptr<juce::MemoryMappedFile> mapped_file;
+
+    const juce::uint8* sample_data;
+    juce::int64 length_in_samples;
+    double sample_rate;
+    int channels_count;
+    int bytes_per_frame;
+    InterleavedPcm::SampleFormat sample_format;
+    juce::uint32 channel_mask; // WAVE_FORMAT_EXTENSIBLE speaker positions, 0 if file doesn't have them
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MappedWavFile)
+};
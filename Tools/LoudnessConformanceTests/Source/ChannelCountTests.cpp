@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    ChannelCountTests.cpp
+
+    LufsChannelBank filters channels in SIMD groups of 4 lanes (registers of 4 floats or 2 doubles).
+    Loudness must not depend on how many channels share a group, nor on which group or lane a channel lands in.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TestSignals.h"
+#include "LoudnessMeasurement.h"
+
+class ChannelCountTests : public juce::UnitTest {
+public:
+    ChannelCountTests() : juce::UnitTest("Channel counts", "Loudness") {}
+
+    void runTest() override
+    {
+        // Every channel at other level, so that channels mixed up between lanes or groups show up
+        std::vector<double> levels;
+        for (int channel = 0; channel < max_channels_count; ++channel) {
+            levels.push_back(-20.0 - channel);
+        }
+
+        // Reference - every channel measured on its own, as mono
+        std::vector<double> reference_integrated_loudness;
+        std::vector<double> reference_short_term_loudness;
+        for (double level : levels) {
+            auto signal = TestSignals::makeSineSegments(sample_rate, { { signal_seconds, { level } } });
+            const auto measurement = LoudnessMeasurements::measure(signal, sample_rate, juce::AudioChannelSet::discreteChannels(1),
+                                                                   512, LufsChannelBank::sub_bins_per_bin, 0.0, getRandom());
+            reference_integrated_loudness.push_back(measurement.integrated_loudness);
+            reference_short_term_loudness.push_back(measurement.short_term_loudness);
+        }
+
+        for (int block_size : TestSignals::getBlockSizes()) {
+            beginTest("1 to " + juce::String(max_channels_count) + " channels, " + TestSignals::getBlockSizeName(block_size));
+
+            for (int channels_count = 1; channels_count <= max_channels_count; ++channels_count) {
+                const std::vector<double> channel_levels(levels.begin(), levels.begin() + channels_count);
+                auto signal = TestSignals::makeSineSegments(sample_rate, { { signal_seconds, channel_levels } });
+                const auto measurement = LoudnessMeasurements::measure(signal, sample_rate, juce::AudioChannelSet::discreteChannels(channels_count),
+                                                                       block_size, LufsChannelBank::sub_bins_per_bin, 0.0, getRandom());
+
+                // Stationary signals - nothing is gated, integrated loudness is the loudness of summed channel powers
+                double power_sum = 0.0;
+                for (int channel = 0; channel < channels_count; ++channel) {
+                    power_sum += loudnessToPower(reference_integrated_loudness[static_cast<size_t>(channel)]);
+                }
+
+                const juce::String name = juce::String(channels_count) + " channels";
+                expectWithinAbsoluteError(measurement.integrated_loudness, LoudnessHistogram::powerToLoudness(power_sum), tolerance, name + " integrated");
+
+                expectEquals(static_cast<int>(measurement.channel_short_term_loudness.size()), channels_count, name + " channels measured");
+                for (int channel = 0; channel < static_cast<int>(measurement.channel_short_term_loudness.size()); ++channel) {
+                    expectWithinAbsoluteError(measurement.channel_short_term_loudness[static_cast<size_t>(channel)],
+                                              reference_short_term_loudness[static_cast<size_t>(channel)], tolerance,
+                                              name + ", short term of channel " + juce::String(channel));
+                }
+            }
+        }
+    }
+
+private:
+    // Inverse of LoudnessHistogram::powerToLoudness
+    static double loudnessToPower(double loudness)
+    {
+        return std::pow(10.0, (loudness + 0.691) / 10.0);
+    }
+
+    static constexpr int max_channels_count = 17; // Crosses every group boundary up to 4 groups (4/5, 8/9, 12/13, 16/17), 13 and more float lanes are filtered register by register
+    static constexpr double sample_rate = 48000.0;
+    static constexpr double signal_seconds = 5.0;
+
+    // Every lane runs the same filter - only the order in which channel powers are summed differs
+    static constexpr double tolerance = 0.001;
+};
+
+static ChannelCountTests channelCountTests;
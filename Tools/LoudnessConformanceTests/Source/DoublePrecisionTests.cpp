@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    DoublePrecisionTests.cpp
+
+    Double precision host buffers are filtered in double. Loudness of double input is compared with a plain scalar
+    BS.1770 implementation in double (K-weighting, 400ms / 3s blocks every 100ms, two-pass gating over all blocks),
+    at rates up to 192kHz, where poles of the high pass lie closest to z = 1.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/Calculations/LUFS/LufsCalculations.h"
+
+class DoublePrecisionTests : public juce::UnitTest {
+public:
+    DoublePrecisionTests() : juce::UnitTest("Double precision input", "Loudness") {}
+
+    void runTest() override
+    {
+        for (double sample_rate : { 44100.0, 48000.0, 96000.0, 192000.0 }) {
+            beginTest("Double input at " + juce::String(sample_rate / 1000.0) + "kHz");
+
+            // 20Hz is where float filters are furthest from double ones, noise covers the whole band
+            checkSignal(sample_rate, "20Hz sine", [sample_rate](int, int i) { return 0.1 * std::sin(juce::MathConstants<double>::twoPi * 20.0 * i / sample_rate); });
+            checkSignal(sample_rate, "1kHz sine", [sample_rate](int channel, int i) { return 0.1 * std::sin(juce::MathConstants<double>::twoPi * 1000.0 * i / sample_rate + channel); });
+
+            auto& random = getRandom();
+            checkSignal(sample_rate, "noise", [&random](int, int) { return 0.2 * (random.nextDouble() - 0.5); });
+        }
+    }
+
+private:
+    void checkSignal(double sampleRate, const juce::String& name, const std::function<double(int, int)>& nextSample)
+    {
+        const int samples_count = juce::roundToInt(signal_seconds * sampleRate);
+        juce::AudioBuffer<double> signal(channels_count, samples_count);
+        for (int channel = 0; channel < channels_count; ++channel) {
+            for (int i = 0; i < samples_count; ++i) {
+                signal.setSample(channel, i, nextSample(channel, i));
+            }
+        }
+
+        const Reference reference = calculateReference(signal, sampleRate);
+
+        for (int block_size : { 512, samples_count }) {
+            std::atomic<float> momentary_loudness, integrated_loudness, short_term_loudness, loudness_range;
+            LufsCalculations calculations;
+            calculations.last_momentary_loudness = &momentary_loudness;
+            calculations.integrated_loudness = &integrated_loudness;
+            calculations.short_term_loudness = &short_term_loudness;
+            calculations.loudness_range = &loudness_range;
+
+            calculations.prepareToPlay(sampleRate, block_size, juce::AudioChannelSet::stereo());
+            calculations.clearCounters();
+
+            for (int position = 0; position < samples_count; position += block_size) {
+                const int length = std::min(block_size, samples_count - position);
+                const juce::AudioBuffer<double> block(signal.getArrayOfWritePointers(), channels_count, position, length);
+                calculations.processBlock(block, channels_count);
+            }
+
+            const juce::String test_name = name + ", " + juce::String(block_size) + " sample blocks, ";
+            expectWithinAbsoluteError(calculations.getIntegratedLoudness(), reference.integrated_loudness, tolerance, test_name + "integrated");
+            expectWithinAbsoluteError(calculations.getMomentaryLoudness(), reference.momentary_loudness, tolerance, test_name + "momentary");
+            expectWithinAbsoluteError(calculations.getShortTermLoudness(), reference.short_term_loudness, tolerance, test_name + "short term");
+        }
+    }
+
+    struct Reference {
+        double integrated_loudness = 0.0;
+        double momentary_loudness = 0.0; // Of the last 400ms block
+        double short_term_loudness = 0.0; // Of the last 3s block
+    };
+
+    static Reference calculateReference(const juce::AudioBuffer<double>& signal, double sampleRate)
+    {
+        const auto coefficients = KWeightingCoefficients::forSampleRate(sampleRate);
+        const int samples_count = signal.getNumSamples();
+
+        // Stereo - both channels have weight 1
+        std::vector<double> squares(static_cast<size_t>(samples_count), 0.0);
+        for (int channel = 0; channel < signal.getNumChannels(); ++channel) {
+            Biquad shelf { coefficients.high_shelf }, pass { coefficients.high_pass };
+            for (int i = 0; i < samples_count; ++i) {
+                const double output = pass.process(shelf.process(signal.getSample(channel, i)));
+                squares[static_cast<size_t>(i)] += output * output;
+            }
+        }
+
+        const int bin_length = static_cast<int>(sampleRate / 10.0);
+        auto getBlockPower = [&squares, bin_length](int end, int bins_count) {
+            double sum = 0.0;
+            for (int i = end - bins_count * bin_length; i < end; ++i) {
+                sum += squares[static_cast<size_t>(i)];
+            }
+            return sum / (bins_count * bin_length);
+        };
+
+        const int bins_count = samples_count / bin_length;
+        std::vector<double> block_powers;
+        for (int bin = 4; bin <= bins_count; ++bin) {
+            block_powers.push_back(getBlockPower(bin * bin_length, 4));
+        }
+
+        Reference reference;
+        reference.momentary_loudness = LoudnessHistogram::powerToLoudness(block_powers.back());
+        reference.short_term_loudness = LoudnessHistogram::powerToLoudness(getBlockPower(bins_count * bin_length, 30));
+
+        // Two-pass gating: absolute gate -70 LUFS, then relative gate 10 LU below loudness of blocks above the absolute one
+        auto getGatedLoudness = [&block_powers](double gate) {
+            double sum = 0.0;
+            int count = 0;
+            for (double power : block_powers) {
+                if (LoudnessHistogram::powerToLoudness(power) > gate) {
+                    sum += power;
+                    count++;
+                }
+            }
+            return LoudnessHistogram::powerToLoudness(sum / count);
+        };
+        reference.integrated_loudness = getGatedLoudness(std::max(-70.0, getGatedLoudness(-70.0) - 10.0));
+
+        return reference;
+    }
+
+    // Transposed direct form II, as in LufsChannelBank
+    struct Biquad {
+        BiquadCoefficients coefficients;
+        double z1 = 0.0;
+        double z2 = 0.0;
+
+        double process(double input)
+        {
+            const double output = coefficients.b0 * input + z1;
+            z1 = coefficients.b1 * input - coefficients.a1 * output + z2;
+            z2 = coefficients.b2 * input - coefficients.a2 * output;
+            return output;
+        }
+    };
+
+    static constexpr int channels_count = 2;
+    static constexpr double signal_seconds = 10.0;
+
+    // LU. Measured: below 1e-12 LU at every rate. Filters in float differ by up to 0.026 LU at 192kHz for the 20Hz sine.
+    static constexpr double tolerance = 1e-9;
+};
+
+static DoublePrecisionTests doublePrecisionTests;
@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    EbuConformanceTests.cpp
+
+    Test signals of EBU Tech 3341 (loudness and true peak) and EBU Tech 3342 (loudness range)
+    that can be synthesized - cases built from authentic programme files are not included.
+
+  ==============================================================================
+*/
+
+// sources:
+//https://tech.ebu.ch/docs/tech/tech3341.pdf
+//https://tech.ebu.ch/docs/tech/tech3342.pdf
+
+#include <JuceHeader.h>
+#include "TestSignals.h"
+#include "LoudnessMeasurement.h"
+
+// Sample rates every loudness case is run at - EBU defines signals at 48kHz, weighting has to hold at other rates too
+static const double sample_rates[] = { 44100.0, 48000.0, 96000.0 };
+
+// Momentary and short term windows slide once per bin (default) and once per sub bin
+static const int update_intervals[] = { LufsChannelBank::sub_bins_per_bin, 1 };
+
+static constexpr double loudness_tolerance = 0.1; // LU, momentary, short term and integrated (EBU Tech 3341)
+static constexpr double loudness_range_tolerance = 1.0; // LU (EBU Tech 3342)
+
+// True peak meter may read 0.4 dB below and 0.2 dB above the true value (EBU Tech 3341)
+static constexpr double true_peak_tolerance_below = 0.4;
+static constexpr double true_peak_tolerance_above = 0.2;
+
+class EbuTech3341Tests : public juce::UnitTest {
+public:
+    EbuTech3341Tests() : juce::UnitTest("EBU Tech 3341", "Loudness") {}
+
+    void runTest() override
+    {
+        for (double sample_rate : sample_rates) {
+            for (int block_size : TestSignals::getBlockSizes()) {
+                const juce::String variant = juce::String(sample_rate / 1000.0) + "kHz, " + TestSignals::getBlockSizeName(block_size);
+
+                beginTest("Stationary signals, " + variant);
+                runStationaryCase("Case 1", sample_rate, block_size, -23.0);
+                runStationaryCase("Case 2", sample_rate, block_size, -33.0);
+
+                beginTest("Integrated loudness gating, " + variant);
+                runIntegratedCase("Case 3", sample_rate, block_size, juce::AudioChannelSet::stereo(),
+                                  { TestSignals::stereo(10.0, -36.0), TestSignals::stereo(60.0, -23.0), TestSignals::stereo(10.0, -36.0) });
+                runIntegratedCase("Case 4", sample_rate, block_size, juce::AudioChannelSet::stereo(),
+                                  { TestSignals::stereo(10.0, -72.0), TestSignals::stereo(10.0, -36.0), TestSignals::stereo(60.0, -23.0),
+                                    TestSignals::stereo(10.0, -36.0), TestSignals::stereo(10.0, -72.0) });
+                runIntegratedCase("Case 5", sample_rate, block_size, juce::AudioChannelSet::stereo(),
+                                  { TestSignals::stereo(20.0, -26.0), TestSignals::stereo(20.1, -20.0), TestSignals::stereo(20.0, -26.0) });
+
+                beginTest("Channel weights, " + variant);
+                // L, R, C, Ls, Rs - the order of create5point0
+                runIntegratedCase("Case 6", sample_rate, block_size, juce::AudioChannelSet::create5point0(),
+                                  { { 20.0, { -28.0, -28.0, -24.0, -30.0, -30.0 } } });
+
+                for (int update_interval : update_intervals) {
+                    beginTest("Window lengths, update every " + juce::String(update_interval * 10) + "ms, " + variant);
+                    runWindowCases(sample_rate, block_size, update_interval);
+                }
+            }
+        }
+
+        for (int block_size : TestSignals::getBlockSizes()) {
+            beginTest("True peak, " + TestSignals::getBlockSizeName(block_size));
+
+            // Case 19 expects +3.0 dBTP, 1.41 is amplitude of the signal given in the specification
+            constexpr double sample_rate = 48000.0;
+            runTruePeakCase("Case 15", block_size, sample_rate / 4.0, 0.5, 0.0, -6.0);
+            runTruePeakCase("Case 16", block_size, sample_rate / 4.0, 0.5, 45.0, -6.0);
+            runTruePeakCase("Case 17", block_size, sample_rate / 6.0, 0.5, 60.0, -6.0);
+            runTruePeakCase("Case 18", block_size, sample_rate / 8.0, 0.5, 67.5, -6.0);
+            runTruePeakCase("Case 19", block_size, sample_rate / 4.0, 1.41, 45.0, 3.0);
+        }
+    }
+
+private:
+    // 20s of stereo sine - momentary, short term and integrated loudness are all equal to level
+    void runStationaryCase(const juce::String& name, double sampleRate, int blockSize, double level)
+    {
+        auto signal = TestSignals::makeSineSegments(sampleRate, { TestSignals::stereo(20.0, level) });
+        const auto measurement = LoudnessMeasurements::measure(signal, sampleRate, juce::AudioChannelSet::stereo(),
+                                                               blockSize, LufsChannelBank::sub_bins_per_bin, 3.0, getRandom());
+
+        logMessage(name + ": M " + juce::String(measurement.momentary_loudness, 3) + ", S " + juce::String(measurement.short_term_loudness, 3)
+                   + ", I " + juce::String(measurement.integrated_loudness, 3) + " LUFS (expected " + juce::String(level, 1) + ")");
+
+        expectWithinAbsoluteError(measurement.momentary_loudness, level, loudness_tolerance, name + " momentary");
+        expectWithinAbsoluteError(measurement.short_term_loudness, level, loudness_tolerance, name + " short term");
+        expectWithinAbsoluteError(measurement.integrated_loudness, level, loudness_tolerance, name + " integrated");
+    }
+
+    // Integrated loudness of -23 LUFS
+    void runIntegratedCase(const juce::String& name, double sampleRate, int blockSize, const juce::AudioChannelSet& channelSet,
+                           const std::vector<SineSegment>& segments)
+    {
+        auto signal = TestSignals::makeSineSegments(sampleRate, segments);
+        const auto measurement = LoudnessMeasurements::measure(signal, sampleRate, channelSet,
+                                                               blockSize, LufsChannelBank::sub_bins_per_bin, 0.0, getRandom());
+
+        logMessage(name + ": I " + juce::String(measurement.integrated_loudness, 3) + " LUFS (expected -23.0)");
+        expectWithinAbsoluteError(measurement.integrated_loudness, -23.0, loudness_tolerance, name + " integrated");
+    }
+
+    // Tone bursts repeating with the period of the window - loudness read in the window stays at -23 LUFS
+    void runWindowCases(double sampleRate, int blockSize, int updateInterval)
+    {
+        std::vector<SineSegment> short_term_bursts;
+        std::vector<SineSegment> momentary_bursts;
+        for (int i = 0; i < 20; ++i) {
+            short_term_bursts.push_back(TestSignals::stereo(1.34, -20.0));
+            short_term_bursts.push_back(TestSignals::stereo(1.66, -30.0));
+            momentary_bursts.push_back(TestSignals::stereo(0.18, -20.0));
+            momentary_bursts.push_back(TestSignals::stereo(0.22, -30.0));
+        }
+
+        auto short_term_signal = TestSignals::makeSineSegments(sampleRate, short_term_bursts);
+        const auto short_term = LoudnessMeasurements::measure(short_term_signal, sampleRate, juce::AudioChannelSet::stereo(),
+                                                              blockSize, updateInterval, 3.0, getRandom());
+        checkWindow("Case 9 short term", short_term.short_term_loudness_range);
+        expectWithinAbsoluteError(short_term.max_short_term_loudness, -23.0, loudness_tolerance, "Case 9 max short term");
+
+        auto momentary_signal = TestSignals::makeSineSegments(sampleRate, momentary_bursts);
+        const auto momentary = LoudnessMeasurements::measure(momentary_signal, sampleRate, juce::AudioChannelSet::stereo(),
+                                                             blockSize, updateInterval, 0.4, getRandom());
+        checkWindow("Case 12 momentary", momentary.momentary_loudness_range);
+        expectWithinAbsoluteError(momentary.max_momentary_loudness, -23.0, loudness_tolerance, "Case 12 max momentary");
+    }
+
+    void checkWindow(const juce::String& name, juce::Range<double> loudnessRange)
+    {
+        logMessage(name + ": " + juce::String(loudnessRange.getStart(), 3) + " to " + juce::String(loudnessRange.getEnd(), 3) + " LUFS (expected -23.0)");
+        expectWithinAbsoluteError(loudnessRange.getStart(), -23.0, loudness_tolerance, name + " lowest");
+        expectWithinAbsoluteError(loudnessRange.getEnd(), -23.0, loudness_tolerance, name + " highest");
+    }
+
+    // 1s of stereo sine at 48kHz
+    void runTruePeakCase(const juce::String& name, int blockSize, double frequency, double amplitude, double phaseDegrees, double expectedTruePeak)
+    {
+        constexpr double sample_rate = 48000.0;
+        auto signal = TestSignals::makeSine(sample_rate, 1.0, frequency, amplitude, phaseDegrees, 2);
+        const double true_peak = LoudnessMeasurements::measureTruePeak(signal, sample_rate, blockSize, getRandom());
+
+        logMessage(name + ": " + juce::String(true_peak, 3) + " dBTP (expected " + juce::String(expectedTruePeak, 1) + ")");
+        expectGreaterOrEqual(true_peak, expectedTruePeak - true_peak_tolerance_below, name + " true peak");
+        expectLessOrEqual(true_peak, expectedTruePeak + true_peak_tolerance_above, name + " true peak");
+    }
+};
+
+class EbuTech3342Tests : public juce::UnitTest {
+public:
+    EbuTech3342Tests() : juce::UnitTest("EBU Tech 3342", "Loudness") {}
+
+    void runTest() override
+    {
+        for (double sample_rate : sample_rates) {
+            for (int block_size : TestSignals::getBlockSizes()) {
+                beginTest("Loudness range, " + juce::String(sample_rate / 1000.0) + "kHz, " + TestSignals::getBlockSizeName(block_size));
+
+                runCase("Case 1", sample_rate, block_size, { TestSignals::stereo(20.0, -20.0), TestSignals::stereo(20.0, -30.0) }, 10.0);
+                runCase("Case 2", sample_rate, block_size, { TestSignals::stereo(20.0, -20.0), TestSignals::stereo(20.0, -15.0) }, 5.0);
+                runCase("Case 3", sample_rate, block_size, { TestSignals::stereo(20.0, -40.0), TestSignals::stereo(20.0, -20.0) }, 20.0);
+                runCase("Case 4", sample_rate, block_size,
+                        { TestSignals::stereo(20.0, -50.0), TestSignals::stereo(20.0, -35.0), TestSignals::stereo(20.0, -20.0),
+                          TestSignals::stereo(20.0, -35.0), TestSignals::stereo(20.0, -50.0) }, 15.0);
+            }
+        }
+    }
+
+private:
+    void runCase(const juce::String& name, double sampleRate, int blockSize, const std::vector<SineSegment>& segments, double expectedRange)
+    {
+        auto signal = TestSignals::makeSineSegments(sampleRate, segments);
+        const auto measurement = LoudnessMeasurements::measure(signal, sampleRate, juce::AudioChannelSet::stereo(),
+                                                               blockSize, LufsChannelBank::sub_bins_per_bin, 0.0, getRandom());
+
+        logMessage(name + ": LRA " + juce::String(measurement.loudness_range, 2) + " LU (expected " + juce::String(expectedRange, 1) + ")");
+        expectWithinAbsoluteError(measurement.loudness_range, expectedRange, loudness_range_tolerance, name + " loudness range");
+    }
+};
+
+static EbuTech3341Tests ebuTech3341Tests;
+static EbuTech3342Tests ebuTech3342Tests;
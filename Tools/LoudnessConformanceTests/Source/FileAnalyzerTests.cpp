@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    FileAnalyzerTests.cpp
+
+    LoudnessAnalyzer reads files through AudioFormatReader (whole or in chunks) or straight from the memory mapped file.
+    WAV channels are interleaved in channel mask bit order, so every path has to weigh them in that order -
+    otherwise the rear and side pair of a 7.1 file swap their weights.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TestSignals.h"
+#include "LoudnessMeasurement.h"
+#include "../../LoudnessAnalyzer/Source/FileAnalyzer.h"
+
+class FileAnalyzerTests : public juce::UnitTest {
+public:
+    FileAnalyzerTests() : juce::UnitTest("File analyzer channel order", "Loudness") {}
+
+    void runTest() override
+    {
+        // 7.1 in file order (mask 0x63F): L R C LFE, back pair (bits 4/5), side pair (bits 9/10).
+        // Back pair is much quieter than the side pair, so swapped weights change integrated loudness by far more than tolerance.
+        const std::vector<double> levels { -20.0, -21.0, -22.0, -23.0, -34.0, -35.0, -14.0, -15.0 };
+        const juce::Array<juce::AudioChannelSet::ChannelType> file_channel_types {
+            juce::AudioChannelSet::left, juce::AudioChannelSet::right, juce::AudioChannelSet::centre, juce::AudioChannelSet::LFE,
+            juce::AudioChannelSet::leftSurroundRear, juce::AudioChannelSet::rightSurroundRear,
+            juce::AudioChannelSet::leftSurroundSide, juce::AudioChannelSet::rightSurroundSide
+        };
+
+        beginTest("7.1 WAV with channel mask 0x63F");
+
+        juce::TemporaryFile temporary_file(".wav");
+        auto signal = TestSignals::makeSineSegments(sample_rate, { { signal_seconds, levels } });
+        expect(writeWav(temporary_file.getFile(), signal, 0x63f), "test file written");
+
+        // Stationary signals - integrated loudness is the loudness of weighted channel powers, each measured as mono
+        double power_sum = 0.0;
+        for (int channel = 0; channel < static_cast<int>(levels.size()); ++channel) {
+            auto mono_signal = TestSignals::makeSineSegments(sample_rate, { { signal_seconds, { levels[static_cast<size_t>(channel)] } } });
+            const auto measurement = LoudnessMeasurements::measure(mono_signal, sample_rate, juce::AudioChannelSet::discreteChannels(1),
+                                                                   512, LufsChannelBank::sub_bins_per_bin, 0.0, getRandom());
+            power_sum += LufsChannelBank::getChannelWeight(file_channel_types[channel]) * loudnessToPower(measurement.integrated_loudness);
+        }
+        const double expected_loudness = LoudnessHistogram::powerToLoudness(power_sum);
+
+        AnalysisResult whole_result, chunks_result, mapped_result;
+        juce::String error;
+
+        FileAnalyzer whole_analyzer;
+        expect(whole_analyzer.analyze(temporary_file.getFile(), whole_result, error), error);
+
+        FileAnalyzer chunks_analyzer;
+        expect(chunks_analyzer.analyzeInChunks(temporary_file.getFile(), chunks_threads_count, chunks_result, error), error);
+
+        FileAnalyzer mapped_analyzer;
+        expect(mapped_analyzer.analyzeMapped(temporary_file.getFile(), mapped_result, error), error);
+
+        expectWithinAbsoluteError(whole_result.integrated_loudness, expected_loudness, tolerance, "analyze");
+        expectWithinAbsoluteError(chunks_result.integrated_loudness, expected_loudness, tolerance, "analyzeInChunks");
+        expectWithinAbsoluteError(mapped_result.integrated_loudness, expected_loudness, tolerance, "analyzeMapped");
+
+        expectWithinAbsoluteError(chunks_result.integrated_loudness, whole_result.integrated_loudness, paths_tolerance, "analyzeInChunks vs analyze");
+        expectWithinAbsoluteError(mapped_result.integrated_loudness, whole_result.integrated_loudness, paths_tolerance, "analyzeMapped vs analyze");
+        expectWithinAbsoluteError(mapped_result.max_short_term_loudness, whole_result.max_short_term_loudness, paths_tolerance, "short term, analyzeMapped vs analyze");
+    }
+
+private:
+    // 16 bit WAVE_FORMAT_EXTENSIBLE file, channels of signal interleaved in the given order
+    static bool writeWav(const juce::File& file, const juce::AudioBuffer<float>& signal, juce::uint32 channelMask)
+    {
+        juce::FileOutputStream stream(file);
+        if (!stream.openedOk()) {
+            return false;
+        }
+
+        const int channels_count = signal.getNumChannels();
+        const int frames_count = signal.getNumSamples();
+        const int bytes_per_frame = channels_count * 2;
+        const int data_size = frames_count * bytes_per_frame;
+
+        stream.write("RIFF", 4);
+        stream.writeInt(4 + 8 + 40 + 8 + data_size);
+        stream.write("WAVE", 4);
+
+        stream.write("fmt ", 4);
+        stream.writeInt(40);
+        stream.writeShort(static_cast<short>(0xfffe));
+        stream.writeShort(static_cast<short>(channels_count));
+        stream.writeInt(static_cast<int>(sample_rate));
+        stream.writeInt(static_cast<int>(sample_rate) * bytes_per_frame);
+        stream.writeShort(static_cast<short>(bytes_per_frame));
+        stream.writeShort(16);
+        stream.writeShort(22);
+        stream.writeShort(16);
+        stream.writeInt(static_cast<int>(channelMask));
+        static const juce::uint8 pcm_sub_format[] = { 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 };
+        stream.write(pcm_sub_format, sizeof(pcm_sub_format));
+
+        stream.write("data", 4);
+        stream.writeInt(data_size);
+        for (int frame = 0; frame < frames_count; ++frame) {
+            for (int channel = 0; channel < channels_count; ++channel) {
+                const float sample = signal.getSample(channel, frame);
+                stream.writeShort(static_cast<short>(juce::jlimit(-32768, 32767, juce::roundToInt(sample * 32768.0f))));
+            }
+        }
+
+        return !stream.getStatus().failed();
+    }
+
+    // Inverse of LoudnessHistogram::powerToLoudness
+    static double loudnessToPower(double loudness)
+    {
+        return std::pow(10.0, (loudness + 0.691) / 10.0);
+    }
+
+    static constexpr double sample_rate = 48000.0;
+    static constexpr double signal_seconds = 40.0; // Long enough for 2 chunks with their pre roll
+    static constexpr int chunks_threads_count = 2;
+
+    // Mono references are float, the file is 16 bit
+    static constexpr double tolerance = 0.01;
+    // All paths see the same 16 bit samples
+    static constexpr double paths_tolerance = 0.001;
+};
+
+static FileAnalyzerTests fileAnalyzerTests;
@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+
+    HistogramTests.cpp
+
+    LoudnessHistogram against exact two-pass gating over sorted blocks (BS.1770, EBU Tech 3342),
+    on random block loudness distributions.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/Calculations/LUFS/LoudnessHistogram.h"
+
+class HistogramTests : public juce::UnitTest {
+public:
+    HistogramTests() : juce::UnitTest("Loudness histogram", "Loudness") {}
+
+    void runTest() override
+    {
+        auto& random = getRandom();
+
+        beginTest("Uniform from -80 to 0 LUFS");
+        runDistribution([&random] { return -80.0 + 80.0 * random.nextDouble(); });
+
+        beginTest("Normal around -23 LUFS");
+        runDistribution([&random] { return -23.0 + 5.0 * nextGaussian(random); });
+
+        beginTest("Quiet and loud parts");
+        runDistribution([&random] { return random.nextBool() ? -40.0 + 3.0 * nextGaussian(random) : -18.0 + 2.0 * nextGaussian(random); });
+
+        beginTest("Blocks around the relative gate");
+        // Half of blocks at -20 LUFS, the other half within 0.1 LU of the relative gate of integrated loudness they give (-32.79 LUFS)
+        runDistribution([&random] { return random.nextBool() ? -20.0 : -32.89 + 0.2 * random.nextDouble(); });
+    }
+
+private:
+    // Exact two-pass result, with bounds of the histogram result documented in LoudnessHistogram.h
+    struct ExactResult {
+        double integrated_loudness = -std::numeric_limits<double>::infinity();
+        double integrated_error_bound = 0.0;
+        double loudness_range = 0.0;
+        double min_loudness_range = 0.0;
+        double max_loudness_range = 0.0;
+    };
+
+    void runDistribution(const std::function<double()>& nextLoudness)
+    {
+        double max_integrated_error = 0.0;
+        double max_range_error = 0.0;
+
+        for (int trial = 0; trial < trials_count; ++trial) {
+            const int blocks_count = 1 + getRandom().nextInt(max_blocks_count);
+
+            LoudnessHistogram histogram;
+            std::vector<double> block_powers;
+            for (int i = 0; i < blocks_count; ++i) {
+                block_powers.push_back(loudnessToPower(nextLoudness()));
+                histogram.addBlock(block_powers.back());
+            }
+
+            const double integrated_loudness = histogram.calculateGatedLoudness(integrated_relative_gate);
+            const double loudness_range = histogram.calculateLoudnessRange(range_relative_gate, low_percentile, high_percentile);
+            const ExactResult exact = calculateExact(block_powers);
+
+            if (std::isinf(exact.integrated_loudness)) {
+                expect(std::isinf(integrated_loudness), "no blocks above the gates");
+                continue;
+            }
+
+            max_integrated_error = std::max(max_integrated_error, std::abs(integrated_loudness - exact.integrated_loudness));
+            max_range_error = std::max(max_range_error, std::abs(loudness_range - exact.loudness_range));
+
+            const juce::String name = juce::String(blocks_count) + " blocks, ";
+            expectWithinAbsoluteError(integrated_loudness, exact.integrated_loudness, exact.integrated_error_bound + rounding_tolerance,
+                                      name + "integrated loudness");
+            expectGreaterOrEqual(loudness_range, exact.min_loudness_range - rounding_tolerance, name + "loudness range");
+            expectLessOrEqual(loudness_range, exact.max_loudness_range + rounding_tolerance, name + "loudness range");
+        }
+
+        logMessage("Largest error of integrated loudness " + juce::String(max_integrated_error, 4)
+                   + " LU, of loudness range " + juce::String(max_range_error, 4) + " LU");
+    }
+
+    // Two-pass gating over all blocks, percentiles of sorted loudness values - memory grows with measurement length
+    static ExactResult calculateExact(const std::vector<double>& blockPowers)
+    {
+        std::vector<double> above_absolute_gate;
+        for (double power : blockPowers) {
+            if (LoudnessHistogram::powerToLoudness(power) > LoudnessHistogram::absolute_gate) {
+                above_absolute_gate.push_back(power);
+            }
+        }
+
+        ExactResult result;
+        if (above_absolute_gate.empty()) {
+            return result;
+        }
+
+        const double mean_loudness = LoudnessHistogram::powerToLoudness(getMean(above_absolute_gate));
+        const double integrated_gate = mean_loudness + integrated_relative_gate;
+        const double range_gate = mean_loudness + range_relative_gate;
+
+        std::vector<double> integrated_blocks;
+        std::vector<double> range_loudness_values;
+        int blocks_above_integrated_band = 0;
+        int blocks_in_integrated_band = 0;
+        int blocks_in_range_band = 0;
+        for (double power : above_absolute_gate) {
+            const double loudness = LoudnessHistogram::powerToLoudness(power);
+            if (loudness > integrated_gate) {
+                integrated_blocks.push_back(power);
+            }
+            if (loudness > range_gate) {
+                range_loudness_values.push_back(loudness);
+            }
+
+            // Blocks the histogram may gate differently - relative gate is rounded to a bin edge
+            blocks_above_integrated_band += loudness > integrated_gate + gate_band;
+            blocks_in_integrated_band += std::abs(loudness - integrated_gate) <= gate_band;
+            blocks_in_range_band += std::abs(loudness - range_gate) <= gate_band;
+        }
+
+        result.integrated_loudness = LoudnessHistogram::powerToLoudness(getMean(integrated_blocks));
+        result.integrated_error_bound = 10.0 * std::log10(1.0 + static_cast<double>(blocks_in_integrated_band) / blocks_above_integrated_band);
+
+        // Percentile of the histogram lies within half of a bin from the block of the same rank among blocks it gated.
+        // Wrongly gated blocks change the count, and so the rank, by at most blocks_in_range_band each.
+        std::sort(range_loudness_values.begin(), range_loudness_values.end());
+        const int last = static_cast<int>(range_loudness_values.size()) - 1;
+        const int low_position = static_cast<int>(last * low_percentile);
+        const int high_position = static_cast<int>(last * high_percentile);
+        const int rank_shift = 2 * blocks_in_range_band + 1;
+        auto loudnessAt = [&range_loudness_values, last](int position) {
+            return range_loudness_values[static_cast<size_t>(juce::jlimit(0, last, position))];
+        };
+
+        result.loudness_range = loudnessAt(high_position) - loudnessAt(low_position);
+        result.min_loudness_range = loudnessAt(high_position - rank_shift) - loudnessAt(low_position + rank_shift) - 2.0 * gate_band;
+        result.max_loudness_range = loudnessAt(high_position + rank_shift) - loudnessAt(low_position - rank_shift) + 2.0 * gate_band;
+
+        return result;
+    }
+
+    static double getMean(const std::vector<double>& values)
+    {
+        return std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+    }
+
+    static double loudnessToPower(double loudness)
+    {
+        return std::pow(10.0, (loudness + 0.691) / 10.0);
+    }
+
+    // Box-Muller
+    static double nextGaussian(juce::Random& random)
+    {
+        const double u = 1.0 - random.nextDouble();
+        return std::sqrt(-2.0 * std::log(u)) * std::cos(juce::MathConstants<double>::twoPi * random.nextDouble());
+    }
+
+    static constexpr int trials_count = 50;
+    static constexpr int max_blocks_count = 20000;
+
+    // Same gates and percentiles as LufsCalculations
+    static constexpr double integrated_relative_gate = -10.0;
+    static constexpr double range_relative_gate = -20.0;
+    static constexpr double low_percentile = 0.10;
+    static constexpr double high_percentile = 0.95;
+
+    static constexpr double gate_band = 0.05; // Half of histogram bin, LU
+    static constexpr double rounding_tolerance = 1e-9;
+};
+
+static HistogramTests histogramTests;
@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    KWeightingTests.cpp
+
+    Magnitude response of KWeightingCoefficients::forSampleRate against the filter published in BS.1770 (48kHz),
+    at fixed frequencies across the audio band - with coefficients in double (as double samples are filtered)
+    and rounded to float (as float samples are filtered).
+
+  ==============================================================================
+*/
+
+// sources:
+//https://www.itu.int/dms_pubrec/itu-r/rec/bs/R-REC-BS.1770-5-202311-I!!PDF-E.pdf (tables 1 and 2)
+
+#include <JuceHeader.h>
+#include <complex>
+#include "../../../Source/Calculations/LUFS/KWeighting.h"
+
+class KWeightingTests : public juce::UnitTest {
+public:
+    KWeightingTests() : juce::UnitTest("K-weighting", "Loudness") {}
+
+    void runTest() override
+    {
+        const KWeightingCoefficients reference {
+            { 1.53512485958697, -2.69169618940638, 1.19839281085285, -1.69065929318241, 0.73248077421585 },
+            { 1.0, -2.0, 1.0, -1.99004745483398, 0.99007225036621 }
+        };
+
+        for (double sample_rate : { 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 }) {
+            beginTest("Magnitude response at " + juce::String(sample_rate / 1000.0) + "kHz");
+
+            const auto coefficients = KWeightingCoefficients::forSampleRate(sample_rate);
+
+            for (double frequency : { 20.0, 30.0, 50.0, 100.0, 200.0, 500.0, 1000.0, 1500.0, 2000.0, 3000.0,
+                                      5000.0, 8000.0, 10000.0, 12000.0, 15000.0, 20000.0 }) {
+                const double reference_response = getMagnitudeResponse<double>(reference, frequency, 48000.0);
+                const double response = getMagnitudeResponse<double>(coefficients, frequency, sample_rate);
+                const double float_response = getMagnitudeResponse<float>(coefficients, frequency, sample_rate);
+
+                // 48kHz coefficients are the published ones, other rates differ by warping of the bilinear transform
+                // and, at the lowest frequencies, float rounding of high pass poles lying close to z = 1
+                const double tolerance = sample_rate == 48000.0 ? same_rate_tolerance : other_rate_tolerance;
+                const double float_tolerance = sample_rate == 48000.0 ? float_same_rate_tolerance
+                                               : (frequency < 50.0 ? float_low_frequency_tolerance : other_rate_tolerance);
+
+                const juce::String name = juce::String(frequency) + "Hz at " + juce::String(sample_rate) + "Hz";
+                expectWithinAbsoluteError(response, reference_response, tolerance, name);
+                expectWithinAbsoluteError(float_response, reference_response, float_tolerance, name + ", float coefficients");
+            }
+        }
+    }
+
+private:
+    // dB, both stages, with coefficients rounded to Coefficient
+    template <typename Coefficient>
+    static double getMagnitudeResponse(const KWeightingCoefficients& coefficients, double frequency, double sampleRate)
+    {
+        const std::complex<double> z1 = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+        const std::complex<double> z2 = z1 * z1;
+
+        std::complex<double> response = 1.0;
+        for (const BiquadCoefficients& stage : { coefficients.high_shelf, coefficients.high_pass }) {
+            const double b0 = static_cast<Coefficient>(stage.b0), b1 = static_cast<Coefficient>(stage.b1), b2 = static_cast<Coefficient>(stage.b2);
+            const double a1 = static_cast<Coefficient>(stage.a1), a2 = static_cast<Coefficient>(stage.a2);
+            response *= (b0 + b1 * z1 + b2 * z2) / (1.0 + a1 * z1 + a2 * z2);
+        }
+
+        return 20.0 * std::log10(std::abs(response));
+    }
+
+    // dB. Measured: 2e-11 dB at 48kHz in double, 3e-5 dB with float coefficients; up to 0.0075 dB at 192kHz around 3kHz;
+    // below 2e-5 dB under 50Hz at every rate in double, up to 0.028 dB at 96kHz at 20Hz with float coefficients
+    static constexpr double same_rate_tolerance = 1e-9;
+    static constexpr double float_same_rate_tolerance = 0.0001;
+    static constexpr double other_rate_tolerance = 0.01;
+    static constexpr double float_low_frequency_tolerance = 0.03;
+};
+
+static KWeightingTests kWeightingTests;
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    LoudnessMeasurement.cpp
+
+  ==============================================================================
+*/
+
+#include "LoudnessMeasurement.h"
+#include "TestSignals.h"
+
+static void includeInRange(juce::Range<double>& range, bool& isEmpty, double value)
+{
+    if (isEmpty) {
+        range = juce::Range<double>(value, value);
+        isEmpty = false;
+    }
+    else {
+        range = range.getUnionWith(value);
+    }
+}
+
+LoudnessMeasurement LoudnessMeasurements::measure(juce::AudioBuffer<float>& signal, double sampleRate, const juce::AudioChannelSet& channelSet,
+                                                  int blockSize, int updateInterval, double settleSeconds, juce::Random& random)
+{
+    std::atomic<float> momentary_loudness, integrated_loudness, short_term_loudness, loudness_range;
+
+    LufsCalculations calculations;
+    calculations.last_momentary_loudness = &momentary_loudness;
+    calculations.integrated_loudness = &integrated_loudness;
+    calculations.short_term_loudness = &short_term_loudness;
+    calculations.loudness_range = &loudness_range;
+
+    calculations.prepareToPlay(sampleRate, blockSize == TestSignals::random_block_sizes ? TestSignals::max_random_block_size : blockSize, channelSet);
+    calculations.setUpdateInterval(updateInterval);
+    calculations.clearCounters();
+
+    LoudnessMeasurement measurement;
+    const juce::int64 settle_samples = static_cast<juce::int64>(std::ceil(settleSeconds * sampleRate));
+    juce::int64 processed_samples = 0;
+    bool momentary_range_empty = true;
+    bool short_term_range_empty = true;
+
+    TestSignals::processInBlocks(signal, blockSize, random, [&](const juce::AudioBuffer<float>& block) {
+        calculations.processBlock(block, block.getNumChannels());
+        processed_samples += block.getNumSamples();
+
+        if (processed_samples >= settle_samples) {
+            includeInRange(measurement.momentary_loudness_range, momentary_range_empty, calculations.getMomentaryLoudness());
+            includeInRange(measurement.short_term_loudness_range, short_term_range_empty, calculations.getShortTermLoudness());
+        }
+    });
+
+    measurement.integrated_loudness = calculations.getIntegratedLoudness();
+    measurement.loudness_range = calculations.getLoudnessRange();
+    measurement.momentary_loudness = calculations.getMomentaryLoudness();
+    measurement.short_term_loudness = calculations.getShortTermLoudness();
+    measurement.max_momentary_loudness = calculations.getMaxMomentaryLoudness();
+    measurement.max_short_term_loudness = calculations.getMaxShortTermLoudness();
+
+    for (int channel = 0; channel < calculations.getChannelsCount(); ++channel) {
+        measurement.channel_short_term_loudness.push_back(calculations.getChannelShortTermLoudness(channel));
+    }
+
+    return measurement;
+}
+
+double LoudnessMeasurements::measureTruePeak(juce::AudioBuffer<float>& signal, double sampleRate, int blockSize, juce::Random& random)
+{
+    std::atomic<float> true_peak;
+
+    TruePeakCalculations calculations;
+    calculations.true_peak = &true_peak;
+
+    calculations.prepareToPlay(sampleRate, blockSize == TestSignals::random_block_sizes ? TestSignals::max_random_block_size : blockSize, signal.getNumChannels());
+    calculations.clearCounters();
+
+    TestSignals::processInBlocks(signal, blockSize, random, [&](const juce::AudioBuffer<float>& block) {
+        calculations.processBlock(block, block.getNumChannels());
+    });
+
+    return calculations.getTruePeak();
+}
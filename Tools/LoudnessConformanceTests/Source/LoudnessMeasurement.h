@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    LoudnessMeasurement.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/Calculations/LUFS/LufsCalculations.h"
+#include "../../../Source/Calculations/TruePeak/TruePeakCalculations.h"
+
+// Everything LufsCalculations reports about a whole signal
+struct LoudnessMeasurement {
+    double integrated_loudness = -std::numeric_limits<double>::infinity();
+    double loudness_range = 0.0;
+    double momentary_loudness = -std::numeric_limits<double>::infinity();
+    double short_term_loudness = -std::numeric_limits<double>::infinity();
+    double max_momentary_loudness = -std::numeric_limits<double>::infinity();
+    double max_short_term_loudness = -std::numeric_limits<double>::infinity();
+
+    // Lowest and highest momentary / short term loudness read after every block, once settle time of the signal passed.
+    // Empty if no block ended after settle time.
+    juce::Range<double> momentary_loudness_range;
+    juce::Range<double> short_term_loudness_range;
+
+    // Short term loudness of every channel on its own at the end of the signal
+    std::vector<double> channel_short_term_loudness;
+};
+
+namespace LoudnessMeasurements {
+    // Measures signal with LufsCalculations prepared for channelSet, fed in blocks of blockSize (see TestSignals::processInBlocks)
+    LoudnessMeasurement measure(juce::AudioBuffer<float>& signal, double sampleRate, const juce::AudioChannelSet& channelSet,
+                                int blockSize, int updateInterval, double settleSeconds, juce::Random& random);
+
+    // dBTP of all channels of signal
+    double measureTruePeak(juce::AudioBuffer<float>& signal, double sampleRate, int blockSize, juce::Random& random);
+}
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    Conformance of loudness and true peak measurement with EBU Tech 3341 and EBU Tech 3342.
+    Runs every test of "Loudness" category and exits with 1 if any of them fails.
+
+    Usage: LoudnessConformanceTests [--seed=N] [--verbose]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+
+// Prints measured values only with --verbose, failed checks ("!!! Test N failed: ...") always
+class ConformanceTestRunner : public juce::UnitTestRunner {
+public:
+    explicit ConformanceTestRunner(bool isVerbose) : verbose(isVerbose) {}
+
+    void logMessage(const juce::String& message) override
+    {
+        if (verbose || message.startsWith("!!!")) {
+            std::cout << message << std::endl;
+        }
+    }
+
+private:
+    bool verbose;
+};
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList arguments(argc, argv);
+
+    // Random block sizes are the same in every run unless other seed is given
+    juce::int64 seed = 1770;
+    if (arguments.containsOption("--seed")) {
+        seed = arguments.getValueForOption("--seed").getLargeIntValue();
+    }
+
+    ConformanceTestRunner runner(arguments.containsOption("--verbose"));
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("Loudness", seed);
+
+    int passes = 0;
+    int failures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i) {
+        const auto* result = runner.getResult(i);
+        passes += result->passes;
+        failures += result->failures;
+
+        std::cout << (result->failures == 0 ? "PASS " : "FAIL ") << result->unitTestName << " / " << result->subcategoryName
+                  << " (" << result->passes << " passed, " << result->failures << " failed)" << std::endl;
+    }
+
+    std::cout << std::endl << passes << " checks passed, " << failures << " failed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    TestSignals.cpp
+
+  ==============================================================================
+*/
+
+// sources:
+//https://tech.ebu.ch/docs/tech/tech3341.pdf
+//https://tech.ebu.ch/docs/tech/tech3342.pdf
+
+#include "TestSignals.h"
+
+juce::AudioBuffer<float> TestSignals::makeSineSegments(double sampleRate, const std::vector<SineSegment>& segments, double frequency)
+{
+    jassert(!segments.empty());
+    const int channels_count = static_cast<int>(segments.front().channel_levels.size());
+
+    int total_samples = 0;
+    for (const auto& segment : segments) {
+        jassert(static_cast<int>(segment.channel_levels.size()) == channels_count);
+        total_samples += juce::roundToInt(segment.seconds * sampleRate);
+    }
+
+    juce::AudioBuffer<float> signal(channels_count, total_samples);
+
+    int position = 0;
+    for (const auto& segment : segments) {
+        const int segment_samples = juce::roundToInt(segment.seconds * sampleRate);
+
+        for (int channel = 0; channel < channels_count; ++channel) {
+            const double amplitude = juce::Decibels::decibelsToGain(segment.channel_levels[static_cast<size_t>(channel)], -std::numeric_limits<double>::infinity());
+            float* samples = signal.getWritePointer(channel, position);
+            for (int i = 0; i < segment_samples; ++i) {
+                const double phase = juce::MathConstants<double>::twoPi * frequency * (position + i) / sampleRate;
+                samples[i] = static_cast<float>(amplitude * std::sin(phase));
+            }
+        }
+        position += segment_samples;
+    }
+
+    return signal;
+}
+
+SineSegment TestSignals::stereo(double seconds, double level)
+{
+    return { seconds, { level, level } };
+}
+
+juce::AudioBuffer<float> TestSignals::makeSine(double sampleRate, double seconds, double frequency, double amplitude, double phaseDegrees, int channelsCount)
+{
+    const int samples_count = juce::roundToInt(seconds * sampleRate);
+    const double phase_offset = juce::degreesToRadians(phaseDegrees);
+    const int fade_in_samples = juce::roundToInt(fade_in_seconds * sampleRate);
+
+    juce::AudioBuffer<float> signal(channelsCount, samples_count);
+    for (int channel = 0; channel < channelsCount; ++channel) {
+        float* samples = signal.getWritePointer(channel);
+        for (int i = 0; i < samples_count; ++i) {
+            const double fade_in = i < fade_in_samples ? 0.5 - 0.5 * std::cos(juce::MathConstants<double>::pi * i / fade_in_samples) : 1.0;
+            samples[i] = static_cast<float>(fade_in * amplitude * std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate + phase_offset));
+        }
+    }
+
+    return signal;
+}
+
+const std::vector<int>& TestSignals::getBlockSizes()
+{
+    static const std::vector<int> block_sizes { 1, 512, 1000000, random_block_sizes };
+    return block_sizes;
+}
+
+void TestSignals::processInBlocks(juce::AudioBuffer<float>& signal, int blockSize, juce::Random& random,
+                                  const std::function<void(const juce::AudioBuffer<float>&)>& processBlock)
+{
+    const int total_samples = signal.getNumSamples();
+
+    for (int position = 0; position < total_samples;) {
+        const int length = std::min(total_samples - position,
+                                    blockSize == random_block_sizes ? 1 + random.nextInt(max_random_block_size) : blockSize);
+
+        const juce::AudioBuffer<float> block(signal.getArrayOfWritePointers(), signal.getNumChannels(), position, length);
+        processBlock(block);
+
+        position += length;
+    }
+}
+
+juce::String TestSignals::getBlockSizeName(int blockSize)
+{
+    return blockSize == random_block_sizes ? juce::String("random blocks") : juce::String(blockSize) + " sample blocks";
+}
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    TestSignals.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Part of a test signal - sine in every channel, at level given per channel in dBFS (peak of the sine, as in EBU Tech 3341).
+// -inf gives silence.
+struct SineSegment {
+    double seconds;
+    std::vector<double> channel_levels;
+};
+
+// Signals of EBU Tech 3341 / 3342 synthesized in code, and feeding them to calculations in blocks
+namespace TestSignals {
+    // Segments follow each other without a gap, phase of the sine continues over segment boundaries
+    juce::AudioBuffer<float> makeSineSegments(double sampleRate, const std::vector<SineSegment>& segments, double frequency = 1000.0);
+
+    // Same level in both channels of a stereo segment
+    SineSegment stereo(double seconds, double level);
+
+    // Single sine in every channel, phase in degrees - true peak signals of EBU Tech 3341.
+    // Sine fades in over fade_in_seconds: abrupt start would make the interpolator ring above the peak of the sine itself.
+    juce::AudioBuffer<float> makeSine(double sampleRate, double seconds, double frequency, double amplitude, double phaseDegrees, int channelsCount);
+
+    static constexpr double fade_in_seconds = 0.02;
+
+    // Block sizes every signal is measured with: single samples, a common host block, whole signal at once
+    // and random_block_sizes
+    const std::vector<int>& getBlockSizes();
+
+    // Block size meaning blocks of random length between 1 and max_random_block_size samples
+    static constexpr int random_block_sizes = 0;
+    static constexpr int max_random_block_size = 30000;
+
+    // Calls processBlock with consecutive blocks of signal. Blocks only refer to the signal, nothing is copied.
+    void processInBlocks(juce::AudioBuffer<float>& signal, int blockSize, juce::Random& random,
+                         const std::function<void(const juce::AudioBuffer<float>&)>& processBlock);
+
+    juce::String getBlockSizeName(int blockSize);
+}
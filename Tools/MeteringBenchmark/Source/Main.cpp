@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    Benchmark of metering hot paths - processor chain, LUFS, channel bank, true peak and spectrum queue,
+    over a grid of sample rates, channel counts and block sizes.
+
+    Usage: MeteringBenchmark [--targets=processor,lufs,bank,truepeak,spectrum] [--sample-rates=44100,48000,96000,192000]
+                             [--channels=1,2,4,5,6,8,9,12,13,16,17] [--block-sizes=16,64,256,1024,4096,8192]
+                             [--precision=float,double] [--seconds=N] [--format=table|csv] [--max-cost-growth=RATIO]
+
+    LUFS channel bank filters float input in groups of 4 lanes (SSE, NEON and the scalar fallback alike), double input
+    in registers of 2 lanes. Default channel counts cross group boundaries (4/5, 8/9, 16/17) and the switch from unrolled
+    to register by register filtering of float input (12/13).
+    With --max-cost-growth it exits with 1 if ns per sample of any channel count is more than RATIO times
+    ns per sample of the smallest channel count of the same target, sample rate, block size and precision.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <cstdlib>
+#include <new>
+#include <map>
+#include "MeteringBenchmark.h"
+
+// Every heap allocation of the process is counted, audio thread code must not allocate at all
+static std::atomic<unsigned long long int> allocations_count { 0 };
+
+void* operator new(std::size_t size)
+{
+    allocations_count++;
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    // SIMD registers in vectors need more than default alignment
+    allocations_count++;
+    const std::size_t alignment_bytes = static_cast<std::size_t>(alignment);
+   #if JUCE_WINDOWS
+    void* pointer = _aligned_malloc(size == 0 ? 1 : size, alignment_bytes);
+   #else
+    void* pointer = std::aligned_alloc(alignment_bytes, ((size + alignment_bytes - 1) / alignment_bytes) * alignment_bytes);
+   #endif
+    if (pointer != nullptr) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+   #if JUCE_WINDOWS
+    _aligned_free(pointer);
+   #else
+    std::free(pointer);
+   #endif
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(pointer, alignment);
+}
+
+static juce::Array<int> parseList(juce::ArgumentList& arguments, const juce::String& option, const juce::String& defaultValue)
+{
+    juce::String value = defaultValue;
+    if (arguments.containsOption(option)) {
+        value = arguments.getValueForOption(option);
+        arguments.removeValueForOption(option);
+    }
+
+    juce::Array<int> list;
+    for (const auto& item : juce::StringArray::fromTokens(value, ",", "")) {
+        if (item.getIntValue() > 0) {
+            list.add(item.getIntValue());
+        }
+    }
+    return list;
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList arguments(argc, argv);
+
+    if (arguments.containsOption("--help|-h")) {
+        std::cout << "Usage: " << arguments.executableName << " [--targets=processor,lufs,bank,truepeak,spectrum] [--sample-rates=44100,48000,96000,192000]" << std::endl;
+        std::cout << "       [--channels=1,2,4,5,6,8,9,12,13,16,17] [--block-sizes=16,64,256,1024,4096,8192] [--precision=float,double]" << std::endl;
+        std::cout << "       [--seconds=N] [--format=table|csv] [--max-cost-growth=RATIO]" << std::endl;
+        return 0;
+    }
+
+    juce::StringArray targets = juce::StringArray::fromTokens("processor,lufs,bank", ",", "");
+    if (arguments.containsOption("--targets")) {
+        targets = juce::StringArray::fromTokens(arguments.getValueForOption("--targets"), ",", "");
+        arguments.removeValueForOption("--targets");
+    }
+
+    const juce::Array<int> sample_rates = parseList(arguments, "--sample-rates", "44100,48000,96000,192000");
+    // Sorted, so that the first channel count is the base of --max-cost-growth
+    juce::Array<int> channel_counts = parseList(arguments, "--channels", "1,2,4,5,6,8,9,12,13,16,17");
+    channel_counts.sort();
+    const juce::Array<int> block_sizes = parseList(arguments, "--block-sizes", "16,64,256,1024,4096,8192");
+
+    juce::StringArray precisions = juce::StringArray::fromTokens("float", ",", "");
+    if (arguments.containsOption("--precision")) {
+        precisions = juce::StringArray::fromTokens(arguments.getValueForOption("--precision"), ",", "");
+        arguments.removeValueForOption("--precision");
+    }
+    for (const auto& precision : precisions) {
+        if (precision != "float" && precision != "double") {
+            std::cerr << "Unknown precision " << precision << std::endl;
+            return 1;
+        }
+    }
+
+    double seconds = 5.0;
+    if (arguments.containsOption("--seconds")) {
+        seconds = juce::jmax(0.1, arguments.getValueForOption("--seconds").getDoubleValue());
+        arguments.removeValueForOption("--seconds");
+    }
+
+    // 0 - cost per channel is not checked
+    double max_cost_growth = 0.0;
+    if (arguments.containsOption("--max-cost-growth")) {
+        max_cost_growth = juce::jmax(0.0, arguments.getValueForOption("--max-cost-growth").getDoubleValue());
+        arguments.removeValueForOption("--max-cost-growth");
+    }
+
+    bool csv = false;
+    if (arguments.containsOption("--format")) {
+        csv = arguments.getValueForOption("--format") == "csv";
+        arguments.removeValueForOption("--format");
+    }
+
+    if (csv) {
+        std::cout << "benchmark,ns_per_sample,channels_per_core,worst_block_us,worst_block_budget_percent,allocations_per_block" << std::endl;
+    }
+    else {
+        std::cout << juce::String("Benchmark").paddedRight(' ', 40) << juce::String("ns/sample").paddedLeft(' ', 12)
+                  << juce::String("ch/core").paddedLeft(' ', 12) << juce::String("worst [us]").paddedLeft(' ', 12)
+                  << juce::String("budget [%]").paddedLeft(' ', 12) << juce::String("allocs/block").paddedLeft(' ', 14) << std::endl;
+    }
+
+    MeteringBenchmark benchmark(seconds, allocations_count);
+    bool cost_growth_exceeded = false;
+
+    for (const auto& target_name : targets) {
+        BenchmarkCase benchmarkCase;
+        if (target_name == "processor") {
+            benchmarkCase.target = BenchmarkCase::Target::processor;
+        }
+        else if (target_name == "lufs") {
+            benchmarkCase.target = BenchmarkCase::Target::lufs;
+        }
+        else if (target_name == "bank") {
+            benchmarkCase.target = BenchmarkCase::Target::channel_bank;
+        }
+        else if (target_name == "truepeak") {
+            benchmarkCase.target = BenchmarkCase::Target::true_peak;
+        }
+        else if (target_name == "spectrum") {
+            benchmarkCase.target = BenchmarkCase::Target::spectrum;
+        }
+        else {
+            std::cerr << "Unknown target " << target_name << std::endl;
+            return 1;
+        }
+
+        for (int sample_rate : sample_rates) {
+            // ns per sample of the smallest channel count, per block size and precision
+            std::map<juce::String, double> base_ns_per_sample;
+
+            for (int channels_count : channel_counts) {
+                for (int block_size : block_sizes) {
+                    for (const auto& precision : precisions) {
+                        benchmarkCase.sample_rate = sample_rate;
+                        benchmarkCase.channels_count = channels_count;
+                        benchmarkCase.block_size = block_size;
+                        benchmarkCase.double_precision = precision == "double";
+
+                        const BenchmarkResult result = benchmark.run(benchmarkCase);
+
+                        if (csv) {
+                            std::cout << benchmarkCase.getName() << "," << result.ns_per_sample << "," << result.channels_per_core << ","
+                                      << result.worst_block_microseconds << "," << result.worst_block_budget_percent << ","
+                                      << result.allocations_per_block << std::endl;
+                        }
+                        else {
+                            std::cout << benchmarkCase.getName().paddedRight(' ', 40)
+                                      << juce::String(result.ns_per_sample, 3).paddedLeft(' ', 12)
+                                      << juce::String(result.channels_per_core, 0).paddedLeft(' ', 12)
+                                      << juce::String(result.worst_block_microseconds, 1).paddedLeft(' ', 12)
+                                      << juce::String(result.worst_block_budget_percent, 2).paddedLeft(' ', 12)
+                                      << juce::String(result.allocations_per_block, 2).paddedLeft(' ', 14) << std::endl;
+                        }
+
+                        const juce::String base_key = juce::String(block_size) + precision;
+                        if (base_ns_per_sample.count(base_key) == 0) {
+                            base_ns_per_sample[base_key] = result.ns_per_sample;
+                        }
+                        else if (max_cost_growth > 0.0 && result.ns_per_sample > base_ns_per_sample[base_key] * max_cost_growth) {
+                            std::cerr << "Cost per channel of " << benchmarkCase.getName() << " is "
+                                      << juce::String(result.ns_per_sample / base_ns_per_sample[base_key], 2) << " times the cost of "
+                                      << channel_counts.getFirst() << " channels" << std::endl;
+                            cost_growth_exceeded = true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return cost_growth_exceeded ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    MeteringBenchmark.cpp
+
+  ==============================================================================
+*/
+
+#include "MeteringBenchmark.h"
+
+juce::String BenchmarkCase::getName() const
+{
+    return MeteringBenchmark::getTargetName(target) + "/" + juce::String(juce::roundToInt(sample_rate)) + "Hz/"
+        + juce::String(channels_count) + "ch/" + juce::String(block_size) + (double_precision ? "/double" : "");
+}
+
+MeteringBenchmark::MeteringBenchmark(double seconds, const std::atomic<unsigned long long int>& allocationsCounter) :
+    seconds_per_case(seconds),
+    allocations_counter(allocationsCounter)
+{
+}
+
+juce::String MeteringBenchmark::getTargetName(BenchmarkCase::Target target)
+{
+    switch (target) {
+    case BenchmarkCase::Target::processor:
+        return "processor";
+    case BenchmarkCase::Target::lufs:
+        return "lufs";
+    case BenchmarkCase::Target::channel_bank:
+        return "bank";
+    case BenchmarkCase::Target::true_peak:
+        return "truepeak";
+    case BenchmarkCase::Target::spectrum:
+        return "spectrum";
+    }
+    return {};
+}
+
+BenchmarkResult MeteringBenchmark::run(const BenchmarkCase& benchmarkCase)
+{
+    if (benchmarkCase.double_precision) {
+        return runWithSamples<double>(benchmarkCase);
+    }
+    return runWithSamples<float>(benchmarkCase);
+}
+
+template <typename SampleType>
+BenchmarkResult MeteringBenchmark::runWithSamples(const BenchmarkCase& benchmarkCase)
+{
+    const int channels_count = benchmarkCase.channels_count;
+    const int block_size = benchmarkCase.block_size;
+    const double sample_rate = benchmarkCase.sample_rate;
+
+    // Same layout a host would give for this number of channels (LFE of 5.1 and 7.1 is not measured by LUFS)
+    const juce::AudioChannelSet channel_set = juce::AudioChannelSet::canonicalChannelSet(channels_count);
+
+    // Values published by the calculations, like APVTS parameters in the plugin
+    std::atomic<float> zero_passes, rms, min, max;
+    std::atomic<float> momentary_loudness, integrated_loudness, short_term_loudness, loudness_range;
+    std::atomic<float> true_peak;
+
+    StatisticsCalculations statisticsCalc;
+    LufsCalculations lufsCalc;
+    TruePeakCalculations truePeakCalc;
+    LufsChannelBank channelBank;
+    SpectrumCalculations spectrumCalc;
+
+    statisticsCalc.zero_passes = &zero_passes;
+    statisticsCalc.rms = &rms;
+    statisticsCalc.min = &min;
+    statisticsCalc.max = &max;
+    lufsCalc.last_momentary_loudness = &momentary_loudness;
+    lufsCalc.integrated_loudness = &integrated_loudness;
+    lufsCalc.short_term_loudness = &short_term_loudness;
+    lufsCalc.loudness_range = &loudness_range;
+    truePeakCalc.true_peak = &true_peak;
+
+    statisticsCalc.prepareToPlay(sample_rate, block_size, channels_count);
+    lufsCalc.prepareToPlay(sample_rate, block_size, channel_set);
+    truePeakCalc.prepareToPlay(sample_rate, block_size, channels_count);
+    channelBank.prepareToPlay(sample_rate, block_size, channel_set, KWeightingCoefficients::forSampleRate(sample_rate));
+    spectrumCalc.prepareToPlay(sample_rate, block_size, channels_count);
+
+    statisticsCalc.clearCounters();
+    lufsCalc.clearCounters();
+    truePeakCalc.clearCounters();
+    spectrumCalc.clearCounters();
+
+    // About one second of noise, cut into blocks. Blocks only refer to it, so nothing is copied while timing.
+    const int blocks_in_source = std::max(1, juce::roundToInt(sample_rate / block_size));
+    juce::AudioBuffer<SampleType> source(channels_count, blocks_in_source * block_size);
+    juce::Random random(1234);
+    for (int channel = 0; channel < channels_count; ++channel) {
+        SampleType* samples = source.getWritePointer(channel);
+        for (int i = 0; i < source.getNumSamples(); ++i) {
+            samples[i] = static_cast<SampleType>((random.nextDouble() * 2.0 - 1.0) * 0.25);
+        }
+    }
+
+    std::vector<juce::AudioBuffer<SampleType>> blocks;
+    blocks.reserve(static_cast<size_t>(blocks_in_source));
+    for (int block = 0; block < blocks_in_source; ++block) {
+        blocks.emplace_back(source.getArrayOfWritePointers(), channels_count, block * block_size, block_size);
+    }
+
+    auto processBlock = [&](const juce::AudioBuffer<SampleType>& block) {
+        switch (benchmarkCase.target) {
+        case BenchmarkCase::Target::processor:
+            statisticsCalc.processBlock(block, channels_count);
+            lufsCalc.processBlock(block, channels_count);
+            truePeakCalc.processBlock(block, channels_count);
+            spectrumCalc.processBlock(block, channels_count);
+            break;
+        case BenchmarkCase::Target::lufs:
+            lufsCalc.processBlock(block, channels_count);
+            break;
+        case BenchmarkCase::Target::channel_bank:
+            channelBank.fillBins(block.getArrayOfReadPointers(), 0, block_size);
+            break;
+        case BenchmarkCase::Target::true_peak:
+            truePeakCalc.processBlock(block, channels_count);
+            break;
+        case BenchmarkCase::Target::spectrum:
+            spectrumCalc.processBlock(block, channels_count);
+            break;
+        }
+    };
+
+    juce::ScopedNoDenormals noDenormals;
+
+    // Warm up - caches, branch predictors, and the first 3s of bins that don't give any loudness yet
+    const int warm_up_blocks = std::max(blocks_in_source, juce::roundToInt(3.0 * sample_rate / block_size));
+    for (int block = 0; block < warm_up_blocks; ++block) {
+        processBlock(blocks[static_cast<size_t>(block % blocks_in_source)]);
+    }
+
+    const int blocks_count = std::max(1, juce::roundToInt(seconds_per_case * sample_rate / block_size));
+    const unsigned long long int allocations_before = allocations_counter.load();
+
+    juce::int64 worst_block_ticks = 0;
+    const juce::int64 start_ticks = juce::Time::getHighResolutionTicks();
+    juce::int64 previous_ticks = start_ticks;
+
+    for (int block = 0; block < blocks_count; ++block) {
+        processBlock(blocks[static_cast<size_t>(block % blocks_in_source)]);
+
+        const juce::int64 ticks = juce::Time::getHighResolutionTicks();
+        worst_block_ticks = std::max(worst_block_ticks, ticks - previous_ticks);
+        previous_ticks = ticks;
+    }
+
+    const unsigned long long int allocations = allocations_counter.load() - allocations_before;
+    const double total_seconds = juce::Time::highResolutionTicksToSeconds(previous_ticks - start_ticks);
+    const double worst_block_seconds = juce::Time::highResolutionTicksToSeconds(worst_block_ticks);
+
+    BenchmarkResult result;
+    result.ns_per_sample = total_seconds * 1.0e9 / (static_cast<double>(blocks_count) * block_size * channels_count);
+    result.channels_per_core = (1.0e9 / sample_rate) / result.ns_per_sample;
+    result.worst_block_microseconds = worst_block_seconds * 1.0e6;
+    result.worst_block_budget_percent = worst_block_seconds / (block_size / sample_rate) * 100.0;
+    result.allocations_per_block = static_cast<double>(allocations) / blocks_count;
+    return result;
+}
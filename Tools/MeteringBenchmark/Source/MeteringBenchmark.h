@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    MeteringBenchmark.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/Calculations/Statistics/StatisticsCalculations.h"
+#include "../../../Source/Calculations/LUFS/LufsCalculations.h"
+#include "../../../Source/Calculations/TruePeak/TruePeakCalculations.h"
+#include "../../../Source/Calculations/Spectrum/SpectrumCalculations.h"
+
+struct BenchmarkCase {
+    enum class Target {
+        processor, // Statistics, LUFS, true peak and spectrum in the same order as AudioStatisticsPluginAudioProcessor::processBlock
+        lufs, // LufsCalculations::processBlock
+        channel_bank, // LufsChannelBank::fillBins only (K-weighting and bins, no gating)
+        true_peak, // TruePeakCalculations::processBlock (4x polyphase interpolation of every channel)
+        spectrum // SpectrumCalculations::processBlock only - audio thread side, FFTs run on its worker meanwhile
+    };
+
+    Target target = Target::processor;
+    double sample_rate = 48000.0;
+    int channels_count = 2;
+    int block_size = 512;
+    bool double_precision = false; // Blocks of doubles, as from hosts processing in double precision
+
+
+    juce::String getName() const;
+};
+
+struct BenchmarkResult {
+    double ns_per_sample = 0.0; // Per sample of single channel
+    double channels_per_core = 0.0; // How many channels one core could meter in real time
+    double worst_block_microseconds = 0.0;
+    double worst_block_budget_percent = 0.0; // Worst block time relative to its duration
+    double allocations_per_block = 0.0;
+};
+
+// Runs one case over seconds of generated noise, timing every block.
+// allocationsCounter - counter of heap allocations made by the process (counted by replaced operator new)
+class MeteringBenchmark {
+public:
+    MeteringBenchmark(double seconds, const std::atomic<unsigned long long int>& allocationsCounter);
+
+    BenchmarkResult run(const BenchmarkCase& benchmarkCase);
+
+    static juce::String getTargetName(BenchmarkCase::Target target);
+
+private:
+    template <typename SampleType>
+    BenchmarkResult runWithSamples(const BenchmarkCase& benchmarkCase);
+
+    double seconds_per_case;
+    const std::atomic<unsigned long long int>& allocations_counter;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MeteringBenchmark)
+};